@@ -51,11 +51,11 @@ bool NfcTagBinarySensor::tag_match_ndef_string(const std::shared_ptr<NdefMessage
 
 bool NfcTagBinarySensor::tag_match_tag_name(const std::shared_ptr<NdefMessage> &msg) {
   for (const auto &record : msg->get_records()) {
-    if (record->get_payload().find(HA_TAG_ID_PREFIX) != std::string::npos) {
-      auto rec_substr = record->get_payload().substr(sizeof(HA_TAG_ID_PREFIX) - 1);
-      if (rec_substr.find(this->match_string_) != std::string::npos) {
-        return true;
-      }
+    const std::string &payload = record->get_payload();
+    // searching past the prefix length matches the name without copying it out of the payload
+    if (payload.find(HA_TAG_ID_PREFIX) != std::string::npos &&
+        payload.find(this->match_string_, sizeof(HA_TAG_ID_PREFIX) - 1) != std::string::npos) {
+      return true;
     }
   }
   return false;
@@ -0,0 +1,67 @@
+#include "cbor_writer.h"
+
+#include <cstring>
+
+namespace esphome {
+namespace nfc {
+
+static const uint8_t CBOR_MAJOR_BYTES = 2;
+static const uint8_t CBOR_MAJOR_TEXT = 3;
+static const uint8_t CBOR_MAJOR_MAP = 5;
+static const uint8_t CBOR_INDEFINITE = 31;
+static const uint8_t CBOR_BREAK = 0xFF;
+
+void CborWriter::begin_map() {
+  const uint8_t head = (CBOR_MAJOR_MAP << 5) | CBOR_INDEFINITE;
+  this->write_raw_(&head, 1);
+}
+
+void CborWriter::end() { this->write_raw_(&CBOR_BREAK, 1); }
+
+void CborWriter::write_bytes(const uint8_t *data, const size_t length) {
+  this->write_head_(CBOR_MAJOR_BYTES, length);
+  this->write_raw_(data, length);
+}
+
+void CborWriter::write_text(const char *text, const size_t length) {
+  this->write_head_(CBOR_MAJOR_TEXT, length);
+  this->write_raw_(reinterpret_cast<const uint8_t *>(text), length);
+}
+
+void CborWriter::write_head_(const uint8_t major_type, const uint64_t value) {
+  // the argument goes in the initial byte up to 23, after it in 1, 2, 4 or 8 big-endian bytes beyond that
+  uint8_t head[9];
+  uint8_t extra;
+  if (value < 24) {
+    head[0] = (major_type << 5) | value;
+    extra = 0;
+  } else if (value <= UINT8_MAX) {
+    head[0] = (major_type << 5) | 24;
+    extra = 1;
+  } else if (value <= UINT16_MAX) {
+    head[0] = (major_type << 5) | 25;
+    extra = 2;
+  } else if (value <= UINT32_MAX) {
+    head[0] = (major_type << 5) | 26;
+    extra = 4;
+  } else {
+    head[0] = (major_type << 5) | 27;
+    extra = 8;
+  }
+  for (uint8_t i = 0; i < extra; i++) {
+    head[1 + i] = value >> (8 * (extra - 1 - i));
+  }
+  this->write_raw_(head, 1 + extra);
+}
+
+void CborWriter::write_raw_(const uint8_t *data, const size_t length) {
+  if (this->overflowed_ || length > this->capacity_ - this->size_) {
+    this->overflowed_ = true;
+    return;
+  }
+  std::memcpy(this->buffer_ + this->size_, data, length);
+  this->size_ += length;
+}
+
+}  // namespace nfc
+}  // namespace esphome
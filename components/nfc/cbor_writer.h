@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace esphome {
+namespace nfc {
+
+/// Writes CBOR (RFC 8949) into a caller-supplied buffer. Maps are indefinite-length, so entries can be streamed
+/// out as a parser finds them without counting them first. Once the buffer is full nothing more is written and
+/// overflowed() tells.
+class CborWriter {
+ public:
+  CborWriter(uint8_t *buffer, size_t capacity) : buffer_(buffer), capacity_(capacity) {}
+
+  void begin_map();
+  /// Closes the innermost indefinite-length map
+  void end();
+  void write_bytes(const uint8_t *data, size_t length);
+  void write_text(const char *text, size_t length);
+  void write_text(const std::string &text) { this->write_text(text.data(), text.size()); }
+
+  const uint8_t *data() const { return this->buffer_; }
+  size_t size() const { return this->size_; }
+  bool overflowed() const { return this->overflowed_; }
+
+ protected:
+  void write_head_(uint8_t major_type, uint64_t value);
+  void write_raw_(const uint8_t *data, size_t length);
+
+  uint8_t *buffer_;
+  size_t capacity_;
+  size_t size_{0};
+  bool overflowed_{false};
+};
+
+}  // namespace nfc
+}  // namespace esphome
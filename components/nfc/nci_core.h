@@ -118,6 +118,8 @@ static const uint8_t DEACTIVATION_TYPE_IDLE = 0x00;
 static const uint8_t DEACTIVATION_TYPE_SLEEP = 0x01;
 static const uint8_t DEACTIVATION_TYPE_SLEEP_AF = 0x02;
 static const uint8_t DEACTIVATION_TYPE_DISCOVERY = 0x03;
+// Connection credits; this value in RF_INTF_ACTIVATED_NTF means flow control is disabled for the connection
+static const uint8_t NCI_CONN_CREDITS_FLOW_CONTROL_DISABLED = 0xFF;
 // RF discover map modes
 static const uint8_t RF_DISCOVER_MAP_MODE_POLL = 0x1;
 static const uint8_t RF_DISCOVER_MAP_MODE_LISTEN = 0x2;
@@ -126,6 +128,8 @@ static const uint8_t RF_DISCOVER_NTF_NT_LAST = 0x00;
 static const uint8_t RF_DISCOVER_NTF_NT_LAST_RL = 0x01;
 static const uint8_t RF_DISCOVER_NTF_NT_MORE = 0x02;
 // Important message offsets
+static const uint8_t CORE_CONN_CREDITS_NTF_NUM_ENTRIES = 0 + NCI_PKT_HEADER_SIZE;
+static const uint8_t CORE_CONN_CREDITS_NTF_ENTRIES = 1 + NCI_PKT_HEADER_SIZE;
 static const uint8_t RF_DISCOVER_NTF_DISCOVERY_ID = 0 + NCI_PKT_HEADER_SIZE;
 static const uint8_t RF_DISCOVER_NTF_PROTOCOL = 1 + NCI_PKT_HEADER_SIZE;
 static const uint8_t RF_DISCOVER_NTF_MODE_TECH = 2 + NCI_PKT_HEADER_SIZE;
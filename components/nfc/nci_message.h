@@ -2,34 +2,68 @@
 
 #include "esphome/core/log.h"
 #include "esphome/core/helpers.h"
+#include "nci_core.h"
 
+#include <array>
+#include <initializer_list>
 #include <vector>
 
 namespace esphome {
 namespace nfc {
 
+static const uint16_t NCI_MAX_PAYLOAD_SIZE = 255;
+static const uint16_t NCI_MAX_PACKET_SIZE = NCI_PKT_HEADER_SIZE + NCI_MAX_PAYLOAD_SIZE;
+
+/// Read-only view of an encoded packet; it points into the NciMessage it came from and is only valid until that
+/// message is modified or destroyed.
+class NciPacketSpan {
+ public:
+  NciPacketSpan(const uint8_t *data, size_t size) : data_(data), size_(size) {}
+
+  const uint8_t *data() const { return this->data_; }
+  size_t size() const { return this->size_; }
+  const uint8_t *begin() const { return this->data_; }
+  const uint8_t *end() const { return this->data_ + this->size_; }
+
+ protected:
+  const uint8_t *data_;
+  size_t size_;
+};
+
 class NciMessage {
  public:
   NciMessage() {}
   NciMessage(uint8_t message_type, const std::vector<uint8_t> &payload);
   NciMessage(uint8_t message_type, uint8_t gid, uint8_t oid);
   NciMessage(uint8_t message_type, uint8_t gid, uint8_t oid, const std::vector<uint8_t> &payload);
+  NciMessage(uint8_t message_type, uint8_t gid, uint8_t oid, std::initializer_list<uint8_t> payload);
   NciMessage(const std::vector<uint8_t> &raw_packet);
 
-  std::vector<uint8_t> encode();
+  /// The header is kept current as the message is built, so encoding is just a view over the buffer
+  NciPacketSpan encode() const { return NciPacketSpan(this->nci_message_.data(), this->size()); }
   void reset();
 
   uint8_t get_message_type() const;
   uint8_t get_gid() const;
   uint8_t get_oid() const;
-  uint8_t get_payload_size(bool recompute = false);
+  uint8_t get_payload_size() const;
   uint8_t get_simple_status_response() const;
-  uint8_t get_message_byte(uint8_t offset) const;
-  std::vector<uint8_t> &get_message();
+  uint8_t get_message_byte(uint16_t offset) const;
+
+  /// Raw packet buffer (header followed by payload), sized for the largest possible packet; transports read
+  /// the header into it, then the number of payload bytes it announces.
+  uint8_t *data() { return this->nci_message_.data(); }
+  const uint8_t *data() const { return this->nci_message_.data(); }
+  uint8_t *payload() { return this->nci_message_.data() + NCI_PKT_PAYLOAD_OFFSET; }
+  const uint8_t *payload() const { return this->nci_message_.data() + NCI_PKT_PAYLOAD_OFFSET; }
+  /// Header plus payload length
+  uint16_t size() const { return NCI_PKT_HEADER_SIZE + this->nci_message_[NCI_PKT_LENGTH_OFFSET]; }
 
   bool has_payload() const;
+  /// Packet boundary flag; set on every segment of a data message except the last
+  bool pbf_is_set() const { return this->nci_message_[NCI_PKT_MT_GID_OFFSET] & NCI_PKT_PBF_MASK; }
   bool message_type_is(uint8_t message_type) const;
-  bool message_length_is(uint8_t message_length, bool recompute = false);
+  bool message_length_is(uint8_t message_length) const;
   bool gid_is(uint8_t gid) const;
   bool oid_is(uint8_t oid) const;
   bool simple_status_response_is(uint8_t response) const;
@@ -40,10 +74,16 @@ class NciMessage {
   void set_message_type(uint8_t message_type);
   void set_gid(uint8_t gid);
   void set_oid(uint8_t oid);
+  void set_pbf(bool pbf);
   void set_payload(const std::vector<uint8_t> &payload);
+  void set_payload(std::initializer_list<uint8_t> payload);
+  void set_payload(const uint8_t *payload, uint8_t length);
+  /// For payloads written directly through payload()
+  void set_payload_size(uint8_t length) { this->nci_message_[NCI_PKT_LENGTH_OFFSET] = length; }
 
  protected:
-  std::vector<uint8_t> nci_message_{0, 0, 0};  // three bytes, MT/PBF/GID, OID, payload length/size
+  // three bytes, MT/PBF/GID, OID, payload length/size, followed by up to NCI_MAX_PAYLOAD_SIZE payload bytes
+  std::array<uint8_t, NCI_MAX_PACKET_SIZE> nci_message_{};
 };
 
 }  // namespace nfc
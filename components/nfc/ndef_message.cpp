@@ -7,10 +7,26 @@ namespace nfc {
 static const char *const TAG = "nfc.ndef_message";
 
 NdefMessage::NdefMessage(std::vector<uint8_t> &data) {
-  ESP_LOGV(TAG, "Building NdefMessage with %zu bytes", data.size());
-  uint8_t index = 0;
-  while (index <= data.size()) {
-    uint8_t tnf_byte = data[index++];
+  TagMemory memory(data.data(), data.size());
+  this->decode_(memory, 0, data.size());
+}
+
+NdefMessage::NdefMessage(TagMemory &memory, const uint32_t offset, const uint32_t length) {
+  this->decode_(memory, offset, length);
+}
+
+void NdefMessage::decode_(TagMemory &memory, const uint32_t offset, const uint32_t length) {
+  ESP_LOGV(TAG, "Building NdefMessage with %" PRIu32 " bytes", length);
+  const uint32_t end = offset + length;
+  uint32_t index = offset;
+  while (index < end) {
+    uint8_t header[2];  // flags/TNF and type length
+    if (end - index < sizeof(header) || !memory.read(index, header, sizeof(header))) {
+      ESP_LOGE(TAG, "Corrupt record encountered; NdefMessage constructor aborting");
+      break;
+    }
+    index += sizeof(header);
+    uint8_t tnf_byte = header[0];
     bool me = tnf_byte & 0x40;      // Message End bit (is set if this is the last record of the message)
     bool sr = tnf_byte & 0x10;      // Short record bit (is set if payload size is less or equal to 255 bytes)
     bool il = tnf_byte & 0x08;      // ID length bit (is set if ID Length field exists)
@@ -18,39 +34,43 @@ NdefMessage::NdefMessage(std::vector<uint8_t> &data) {
 
     ESP_LOGVV(TAG, "me=%s, sr=%s, il=%s, tnf=%d", YESNO(me), YESNO(sr), YESNO(il), tnf);
 
-    uint8_t type_length = data[index++];
+    uint8_t type_length = header[1];
+    uint8_t lengths[6];  // payload length (one or four bytes) and ID length
+    const uint8_t lengths_size = (sr ? 1 : 4) + (il ? 1 : 0);
+    if (end - index < lengths_size || !memory.read(index, lengths, lengths_size)) {
+      ESP_LOGE(TAG, "Corrupt record encountered; NdefMessage constructor aborting");
+      break;
+    }
+    index += lengths_size;
     uint32_t payload_length = 0;
     if (sr) {
-      payload_length = data[index++];
+      payload_length = lengths[0];
     } else {
-      payload_length = (static_cast<uint32_t>(data[index]) << 24) | (static_cast<uint32_t>(data[index + 1]) << 16) |
-                       (static_cast<uint32_t>(data[index + 2]) << 8) | static_cast<uint32_t>(data[index + 3]);
-      index += 4;
+      payload_length = (static_cast<uint32_t>(lengths[0]) << 24) | (static_cast<uint32_t>(lengths[1]) << 16) |
+                       (static_cast<uint32_t>(lengths[2]) << 8) | static_cast<uint32_t>(lengths[3]);
     }
 
     uint8_t id_length = 0;
     if (il) {
-      id_length = data[index++];
+      id_length = lengths[lengths_size - 1];
     }
 
     ESP_LOGVV(TAG, "Lengths: type=%d, payload=%" PRIu32 ", id=%d", type_length, payload_length, id_length);
 
-    std::string type_str(data.begin() + index, data.begin() + index + type_length);
-
-    index += type_length;
-
-    std::string id_str = "";
-    if (il) {
-      id_str = std::string(data.begin() + index, data.begin() + index + id_length);
-      index += id_length;
-    }
-
-    if ((data.begin() + index > data.end()) || (data.begin() + index + payload_length > data.end())) {
+    if (end - index < uint32_t(type_length) + id_length || end - index - type_length - id_length < payload_length) {
       ESP_LOGE(TAG, "Corrupt record encountered; NdefMessage constructor aborting");
       break;
     }
 
-    std::vector<uint8_t> payload_data(data.begin() + index, data.begin() + index + payload_length);
+    std::string type_str;
+    std::string id_str;
+    std::vector<uint8_t> payload_data;
+    if (!memory.read(index, type_length, type_str) || !memory.read(index + type_length, id_length, id_str) ||
+        !memory.read(index + type_length + id_length, payload_length, payload_data)) {
+      ESP_LOGE(TAG, "Failed to read record; NdefMessage constructor aborting");
+      break;
+    }
+    index += type_length + id_length + payload_length;
 
     std::unique_ptr<NdefRecord> record;
 
@@ -69,12 +89,9 @@ NdefMessage::NdefMessage(std::vector<uint8_t> &data) {
 
     record->set_id(id_str);
 
-    index += payload_length;
-
     ESP_LOGV(TAG, "Adding record type %s = %s", record->get_type().c_str(), record->get_payload().c_str());
-    this->add_record(std::move(record));
-
-    if (me)
+    // nothing past the records we can hold is worth fetching
+    if (!this->add_record(std::move(record)) || me)
       break;
   }
 }
@@ -8,6 +8,7 @@
 #include "ndef_record.h"
 #include "ndef_record_text.h"
 #include "ndef_record_uri.h"
+#include "tag_memory.h"
 
 namespace esphome {
 namespace nfc {
@@ -18,6 +19,8 @@ class NdefMessage {
  public:
   NdefMessage() = default;
   NdefMessage(std::vector<uint8_t> &data);
+  /// Decodes the message at [offset, offset + length) of the tag, fetching only the parts records occupy
+  NdefMessage(TagMemory &memory, uint32_t offset, uint32_t length);
   NdefMessage(const NdefMessage &msg) {
     records_.reserve(msg.records_.size());
     for (const auto &r : msg.records_) {
@@ -35,6 +38,8 @@ class NdefMessage {
   std::vector<uint8_t> encode();
 
  protected:
+  void decode_(TagMemory &memory, uint32_t offset, uint32_t length);
+
   std::vector<std::shared_ptr<NdefRecord>> records_;
 };
 
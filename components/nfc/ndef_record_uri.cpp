@@ -1,10 +1,57 @@
 #include "ndef_record_uri.h"
 
+#include <cstring>
+
 namespace esphome {
 namespace nfc {
 
 static const char *const TAG = "nfc.ndef_record_uri";
 
+struct UriPrefix {
+  const char *prefix;
+  uint8_t length;
+  uint8_t identifier;
+};
+
+/// PAYLOAD_IDENTIFIERS ordered by descending prefix length, so the first match is also the longest
+static constexpr UriPrefix URI_PREFIXES_BY_LENGTH[] = {
+    {"ftp://anonymous:anonymous@", 26, 0x07},
+    {"https://www.", 12, 0x02},
+    {"urn:epc:tag:", 12, 0x1F},
+    {"urn:epc:pat:", 12, 0x20},
+    {"urn:epc:raw:", 12, 0x21},
+    {"http://www.", 11, 0x01},
+    {"irdaobex://", 11, 0x1C},
+    {"urn:epc:id:", 11, 0x1E},
+    {"ftp://ftp.", 10, 0x08},
+    {"btl2cap://", 10, 0x19},
+    {"tcpobex://", 10, 0x1B},
+    {"telnet://", 9, 0x10},
+    {"btgoep://", 9, 0x1A},
+    {"https://", 8, 0x04},
+    {"btspp://", 8, 0x18},
+    {"urn:epc:", 8, 0x22},
+    {"urn:nfc:", 8, 0x23},
+    {"http://", 7, 0x03},
+    {"mailto:", 7, 0x06},
+    {"ftps://", 7, 0x09},
+    {"sftp://", 7, 0x0A},
+    {"rtsp://", 7, 0x12},
+    {"file://", 7, 0x1D},
+    {"smb://", 6, 0x0B},
+    {"nfs://", 6, 0x0C},
+    {"ftp://", 6, 0x0D},
+    {"dav://", 6, 0x0E},
+    {"news:", 5, 0x0F},
+    {"imap:", 5, 0x11},
+    {"sips:", 5, 0x16},
+    {"tftp:", 5, 0x17},
+    {"tel:", 4, 0x05},
+    {"urn:", 4, 0x13},
+    {"pop:", 4, 0x14},
+    {"sip:", 4, 0x15},
+};
+
 NdefRecordUri::NdefRecordUri(const std::vector<uint8_t> &payload) {
   if (payload.empty()) {
     ESP_LOGE(TAG, "Record payload too short");
@@ -13,11 +60,16 @@ NdefRecordUri::NdefRecordUri(const std::vector<uint8_t> &payload) {
 
   uint8_t payload_identifier = payload[0];  // First byte of payload is prefix code
 
-  std::string uri(payload.begin() + 1, payload.end());
-
+  // size the string once for prefix and remainder rather than inserting the prefix in front afterwards
+  const char *prefix = "";
   if (payload_identifier > 0x00 && payload_identifier <= PAYLOAD_IDENTIFIERS_COUNT) {
-    uri.insert(0, PAYLOAD_IDENTIFIERS[payload_identifier]);
+    prefix = PAYLOAD_IDENTIFIERS[payload_identifier];
   }
+  const size_t prefix_length = std::strlen(prefix);
+  std::string uri;
+  uri.reserve(prefix_length + payload.size() - 1);
+  uri.append(prefix, prefix_length);
+  uri.append(payload.begin() + 1, payload.end());
 
   this->tnf_ = TNF_WELL_KNOWN;
   this->type_ = "U";
@@ -29,17 +81,17 @@ std::vector<uint8_t> NdefRecordUri::get_encoded_payload() {
 
   uint8_t payload_prefix = 0x00;
   uint8_t payload_prefix_length = 0x00;
-  for (uint8_t i = 1; i < PAYLOAD_IDENTIFIERS_COUNT; i++) {
-    std::string prefix = PAYLOAD_IDENTIFIERS[i];
-    if (this->uri_.substr(0, prefix.length()).find(prefix) != std::string::npos) {
-      payload_prefix = i;
-      payload_prefix_length = prefix.length();
+  for (const auto &prefix : URI_PREFIXES_BY_LENGTH) {
+    if (prefix.length <= this->uri_.length() && prefix.prefix[0] == this->uri_[0] &&
+        this->uri_.compare(0, prefix.length, prefix.prefix, prefix.length) == 0) {
+      payload_prefix = prefix.identifier;
+      payload_prefix_length = prefix.length;
       break;
     }
   }
 
+  data.reserve(1 + this->uri_.length() - payload_prefix_length);
   data.push_back(payload_prefix);
-
   data.insert(data.end(), this->uri_.begin() + payload_prefix_length, this->uri_.end());
   return data;
 }
@@ -19,12 +19,16 @@ std::string format_uid(std::vector<uint8_t> &uid) {
   return std::string(buf);
 }
 
-std::string format_bytes(std::vector<uint8_t> &bytes) {
-  char buf[(bytes.size() * 2) + bytes.size() - 1];
+std::string format_bytes(std::vector<uint8_t> &bytes) { return format_bytes(bytes.data(), bytes.size()); }
+
+std::string format_bytes(const uint8_t *bytes, size_t len) {
+  if (len == 0)
+    return std::string();
+  char buf[(len * 2) + len];
   int offset = 0;
-  for (size_t i = 0; i < bytes.size(); i++) {
+  for (size_t i = 0; i < len; i++) {
     const char *format = "%02X";
-    if (i + 1 < bytes.size())
+    if (i + 1 < len)
       format = "%02X ";
     offset += sprintf(buf + offset, format, bytes[i]);
   }
@@ -68,6 +72,43 @@ bool decode_mifare_classic_tlv(std::vector<uint8_t> &data, uint32_t &message_len
   return true;
 }
 
+bool find_ndef_tlv(TagMemory &memory, uint32_t &message_start, uint32_t &message_length) {
+  uint32_t index = 0;
+  uint8_t type;
+  while (memory.read_byte(index, type)) {
+    index++;
+    if (type == TLV_NULL) {
+      continue;
+    }
+    if (type == TLV_TERMINATOR) {
+      return false;
+    }
+
+    uint8_t length[3];
+    if (!memory.read_byte(index, length[0])) {
+      return false;
+    }
+    index++;
+    uint32_t value_length = length[0];
+    if (length[0] == TLV_LONG_LENGTH) {
+      if (!memory.read(index, &length[1], 2)) {
+        return false;
+      }
+      index += 2;
+      value_length = (length[1] << 8) | length[2];
+    }
+
+    if (type == TLV_NDEF_MESSAGE) {
+      message_start = index;
+      message_length = value_length;
+      return true;
+    }
+    // lock/memory control and proprietary TLVs carry nothing we need; step over them without fetching
+    index += value_length;
+  }
+  return false;
+}
+
 uint32_t get_mifare_ultralight_buffer_size(uint32_t message_length) {
   uint32_t buffer_size = message_length + 2 + 1;
   if (buffer_size % MIFARE_ULTRALIGHT_READ_SIZE != 0)
@@ -75,6 +116,22 @@ uint32_t get_mifare_ultralight_buffer_size(uint32_t message_length) {
   return buffer_size;
 }
 
+uint8_t get_mifare_ultralight_config_page(const uint32_t capacity) {
+  // 48 bytes is also a plain Ultralight, whose pages run out before 0x10
+  switch (capacity) {
+    case 128:  // NTAG212, Ultralight EV1 MF0UL21
+      return 0x25;
+    case 144:  // NTAG213
+      return 0x29;
+    case 496:  // NTAG215
+      return 0x83;
+    case 872:  // NTAG216
+      return 0xE3;
+    default:
+      return 0;
+  }
+}
+
 uint32_t get_mifare_classic_buffer_size(uint32_t message_length) {
   uint32_t buffer_size = message_length;
   if (message_length < 255) {
@@ -5,6 +5,7 @@
 #include "ndef_record.h"
 #include "ndef_message.h"
 #include "nfc_tag.h"
+#include "tag_memory.h"
 
 #include <vector>
 
@@ -18,10 +19,93 @@ static const uint8_t MIFARE_CLASSIC_BLOCKS_PER_SECT_LOW = 4;
 static const uint8_t MIFARE_CLASSIC_BLOCKS_PER_SECT_HIGH = 16;
 static const uint8_t MIFARE_CLASSIC_16BLOCK_SECT_START = 32;
 
+// NFC Forum TLV blocks found in the data area of Type 1, Type 2 and Mifare Classic tags
+static const uint8_t TLV_NULL = 0x00;
+static const uint8_t TLV_NDEF_MESSAGE = 0x03;
+static const uint8_t TLV_TERMINATOR = 0xFE;
+static const uint8_t TLV_LONG_LENGTH = 0xFF;  // length continues in the next two bytes
+
 static const uint8_t MIFARE_ULTRALIGHT_PAGE_SIZE = 4;
 static const uint8_t MIFARE_ULTRALIGHT_READ_SIZE = 4;
 static const uint8_t MIFARE_ULTRALIGHT_DATA_START_PAGE = 4;
-static const uint8_t MIFARE_ULTRALIGHT_MAX_PAGE = 255;
+// pages are addressed within sectors of 256; SECTOR_SELECT switches between them on NTAG I2C (plus) and 2K tags
+static const uint16_t MIFARE_ULTRALIGHT_SECTOR_PAGES = 256;
+// the data area's last page in sector 0; lock and configuration pages follow, larger tags continue in sector 1
+static const uint8_t MIFARE_ULTRALIGHT_SECTOR0_LAST_DATA_PAGE = 0xE1;
+// the largest data area a capability container can declare (its size byte counts units of 8 bytes)
+static const uint16_t MIFARE_ULTRALIGHT_MAX_DATA_SIZE = 255 * 8;
+// NTAG21x and Ultralight EV1 password protection: PWD_AUTH answers with the 2 byte PACK
+static const uint8_t MIFARE_ULTRALIGHT_PASSWORD_SIZE = 4;
+static const uint8_t MIFARE_ULTRALIGHT_PACK_SIZE = 2;
+// CFG0 and CFG1, the two configuration pages: AUTH0 is the first protected page, ACCESS.PROT extends the
+// protection from writes to reads
+static const uint8_t MIFARE_ULTRALIGHT_CFG_SIZE = 2 * MIFARE_ULTRALIGHT_PAGE_SIZE;
+static const uint8_t MIFARE_ULTRALIGHT_CFG_AUTH0_OFFSET = 3;
+static const uint8_t MIFARE_ULTRALIGHT_CFG_ACCESS_OFFSET = 4;
+static const uint8_t MIFARE_ULTRALIGHT_ACCESS_PROT = 0x80;
+
+// NFC Forum Type 1 Tag (Topaz): 8 byte blocks in 128 byte segments. Blocks 0x0D-0x0F of segment 0 hold the
+// reserved, lock and OTP bytes; the data area runs from the capability container in block 1 around them.
+static const uint8_t TYPE_1_BLOCK_SIZE = 8;
+static const uint8_t TYPE_1_SEGMENT_SIZE = 128;
+static const uint8_t TYPE_1_CMD_READALL = 0x00;
+static const uint8_t TYPE_1_CMD_RSEG = 0x10;
+static const uint8_t TYPE_1_HR_SIZE = 2;
+static const uint8_t TYPE_1_READALL_SIZE = 120;  // blocks 0x00-0x0E, after HR0 and HR1
+static const uint8_t TYPE_1_HR0_NDEF_MASK = 0xF0;
+static const uint8_t TYPE_1_HR0_NDEF = 0x10;
+static const uint8_t TYPE_1_HR0_STATIC = 0x11;  // 120 byte static memory; other NDEF tags have dynamic memory
+static const uint8_t TYPE_1_CC_OFFSET = 8;
+static const uint8_t TYPE_1_CC_MAGIC = 0xE1;
+static const uint8_t TYPE_1_CC_TMS_OFFSET = 2;  // memory size is 8 * (TMS + 1) bytes
+static const uint8_t TYPE_1_CC_RWA_OFFSET = 3;
+static const uint8_t TYPE_1_DATA_START = 12;
+static const uint8_t TYPE_1_RESERVED_START = 0x0D * TYPE_1_BLOCK_SIZE;
+static const uint8_t TYPE_1_RESERVED_SIZE = 3 * TYPE_1_BLOCK_SIZE;
+
+// NFC Forum Type 3 Tag (FeliCa)
+static const uint8_t FELICA_IDM_SIZE = 8;
+static const uint8_t FELICA_BLOCK_SIZE = 16;
+static const uint8_t FELICA_CMD_POLLING = 0x00;
+static const uint8_t FELICA_CMD_CHECK = 0x06;  // Read Without Encryption
+static const uint8_t FELICA_RSP_CHECK = 0x07;
+static const uint8_t FELICA_CHECK_RSP_HEADER_SIZE = 13;  // length, response code, IDm, status flags, block count
+static const uint8_t FELICA_CHECK_RSP_STATUS1_OFFSET = 10;
+static const uint16_t FELICA_NDEF_SYSTEM_CODE = 0x12FC;
+static const uint16_t FELICA_NDEF_SERVICE_CODE_READ = 0x000B;
+static const uint8_t FELICA_ATTR_NBR_OFFSET = 1;
+static const uint8_t FELICA_ATTR_LN_OFFSET = 11;
+static const uint8_t FELICA_ATTR_CHECKSUM_OFFSET = 14;
+
+// NFC Forum Type 4 Tag: ISO/IEC 7816-4 APDUs over ISO/IEC 14443-4
+static const uint8_t ISO14443_4_SEL_RES_MASK = 0x20;  // SAK bit 6: target is ISO/IEC 14443-4 compliant
+// ATS: T0 tells whether TA(1) is present; TA(1) lists the divisors (bit rates) supported in each direction
+static const uint8_t ISO14443_4_ATS_T0_OFFSET = 1;
+static const uint8_t ISO14443_4_ATS_TA1_OFFSET = 2;
+static const uint8_t ISO14443_4_ATS_T0_TA1_PRESENT = 0x10;
+static const uint8_t ISO14443_4_TA1_SAME_D = 0x80;  // same bit rate required in both directions
+static const uint8_t ISO14443_4_TA1_DS_424 = 0x20;  // PICC to PCD
+static const uint8_t ISO14443_4_TA1_DS_212 = 0x10;
+static const uint8_t ISO14443_4_TA1_DR_424 = 0x02;  // PCD to PICC
+static const uint8_t ISO14443_4_TA1_DR_212 = 0x01;
+static const uint8_t TYPE_4_CLA = 0x00;
+static const uint8_t TYPE_4_INS_SELECT = 0xA4;
+static const uint8_t TYPE_4_INS_READ_BINARY = 0xB0;
+static const uint8_t TYPE_4_SELECT_BY_NAME = 0x04;
+static const uint8_t TYPE_4_SELECT_BY_ID = 0x00;
+static const uint8_t TYPE_4_SELECT_FIRST_NO_FCI = 0x0C;
+static const uint8_t TYPE_4_SW1_OK = 0x90;
+static const uint8_t TYPE_4_SW2_OK = 0x00;
+static const uint8_t TYPE_4_MAX_LE = 0xFF;  // largest Le of a short APDU we request
+static const uint16_t TYPE_4_CC_FILE_ID = 0xE103;
+static const uint8_t TYPE_4_CC_LENGTH = 15;
+static const uint8_t TYPE_4_CC_MLE_OFFSET = 3;
+static const uint8_t TYPE_4_CC_NDEF_TLV_OFFSET = 7;
+static const uint8_t TYPE_4_CC_NDEF_FILE_ID_OFFSET = 9;
+static const uint8_t TYPE_4_CC_NDEF_READ_ACCESS_OFFSET = 13;
+static const uint8_t TYPE_4_NDEF_FILE_CONTROL_TLV = 0x04;
+static const uint8_t TYPE_4_NLEN_SIZE = 2;
+static const uint8_t TYPE_4_NDEF_APP_ID[7] = {0xD2, 0x76, 0x00, 0x00, 0x85, 0x01, 0x01};
 
 static const uint8_t TAG_TYPE_MIFARE_CLASSIC = 0;
 static const uint8_t TAG_TYPE_1 = 1;
@@ -37,6 +121,8 @@ static const uint8_t MIFARE_CMD_HALT = 0x50;
 static const uint8_t MIFARE_CMD_READ = 0x30;
 static const uint8_t MIFARE_CMD_WRITE = 0xA0;
 static const uint8_t MIFARE_CMD_WRITE_ULTRALIGHT = 0xA2;
+static const uint8_t MIFARE_CMD_SECTOR_SELECT = 0xC2;
+static const uint8_t MIFARE_CMD_PWD_AUTH = 0x1B;
 
 // Mifare Ack/Nak
 static const uint8_t MIFARE_CMD_ACK = 0x0A;
@@ -46,7 +132,10 @@ static const uint8_t MIFARE_CMD_NAK_INVALID_XFER_BUFF_INVALID = 0x04;
 static const uint8_t MIFARE_CMD_NAK_CRC_ERROR_XFER_BUFF_INVALID = 0x05;
 
 static const char *const MIFARE_CLASSIC = "Mifare Classic";
+static const char *const NFC_FORUM_TYPE_1 = "NFC Forum Type 1";
 static const char *const NFC_FORUM_TYPE_2 = "NFC Forum Type 2";
+static const char *const NFC_FORUM_TYPE_3 = "NFC Forum Type 3";
+static const char *const NFC_FORUM_TYPE_4 = "NFC Forum Type 4";
 static const char *const ERROR = "Error";
 
 static const uint8_t DEFAULT_KEY[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
@@ -55,21 +144,29 @@ static const uint8_t MAD_KEY[6] = {0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5};
 
 std::string format_uid(std::vector<uint8_t> &uid);
 std::string format_bytes(std::vector<uint8_t> &bytes);
+std::string format_bytes(const uint8_t *bytes, size_t len);
 
 uint8_t guess_tag_type(uint8_t uid_length);
 uint8_t get_mifare_classic_ndef_start_index(std::vector<uint8_t> &data);
 bool decode_mifare_classic_tlv(std::vector<uint8_t> &data, uint32_t &message_length, uint8_t &message_start_index);
 uint32_t get_mifare_classic_buffer_size(uint32_t message_length);
+/// Walks the TLV blocks from the start of `memory` to the first NDEF message TLV
+bool find_ndef_tlv(TagMemory &memory, uint32_t &message_start, uint32_t &message_length);
 
 bool mifare_classic_is_first_block(uint8_t block_num);
 bool mifare_classic_is_trailer_block(uint8_t block_num);
 
 uint32_t get_mifare_ultralight_buffer_size(uint32_t message_length);
+/// Page of CFG0 on the NTAG21x/Ultralight EV1 whose capability container declares `capacity` bytes, 0 for tags
+/// without configuration pages or whose capacity is ambiguous
+uint8_t get_mifare_ultralight_config_page(uint32_t capacity);
 
 class NfcTagListener {
  public:
   virtual void tag_off(NfcTag &tag) {}
   virtual void tag_on(NfcTag &tag) {}
+  /// Asked before a decoded message is reported; returning false has the reader fetch it from the tag again
+  virtual bool ndef_message_is_valid(NdefMessage &message) { return true; }
 };
 
 class Nfcc {
@@ -77,6 +174,15 @@ class Nfcc {
   void register_listener(NfcTagListener *listener) { this->tag_listeners_.push_back(listener); }
 
  protected:
+  bool ndef_message_is_valid_(NdefMessage &message) {
+    for (auto *listener : this->tag_listeners_) {
+      if (!listener->ndef_message_is_valid(message)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   std::vector<NfcTagListener *> tag_listeners_;
 };
 
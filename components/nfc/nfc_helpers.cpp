@@ -5,23 +5,9 @@ namespace nfc {
 
 static const char *const TAG = "nfc.helpers";
 
-bool has_ha_tag_ndef(NfcTag &tag) { return !get_ha_tag_ndef(tag).empty(); }
+bool has_ha_tag_ndef(NfcTag &tag) { return !tag.get_ha_tag_id().empty(); }
 
-std::string get_ha_tag_ndef(NfcTag &tag) {
-  if (!tag.has_ndef_message()) {
-    return std::string();
-  }
-  auto message = tag.get_ndef_message();
-  auto records = message->get_records();
-  for (const auto &record : records) {
-    std::string payload = record->get_payload();
-    size_t pos = payload.find(HA_TAG_ID_PREFIX);
-    if (pos != std::string::npos) {
-      return payload.substr(pos + sizeof(HA_TAG_ID_PREFIX) - 1);
-    }
-  }
-  return std::string();
-}
+std::string get_ha_tag_ndef(NfcTag &tag) { return tag.get_ha_tag_id(); }
 
 std::string get_random_ha_tag_ndef() {
   static const char ALPHANUM[] = "0123456789abcdef";
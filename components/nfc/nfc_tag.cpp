@@ -1,9 +1,25 @@
 #include "nfc_tag.h"
+#include "nfc_helpers.h"
 
 namespace esphome {
 namespace nfc {
 
 static const char *const TAG = "nfc.tag";
 
+void NfcTag::derive_ha_tag_id_() {
+  this->ha_tag_id_.clear();
+  if (this->ndef_message_ == nullptr)
+    return;
+
+  for (const auto &record : this->ndef_message_->get_records()) {
+    const std::string &payload = record->get_payload();
+    const size_t pos = payload.find(HA_TAG_ID_PREFIX);
+    if (pos != std::string::npos) {
+      this->ha_tag_id_.assign(payload, pos + sizeof(HA_TAG_ID_PREFIX) - 1, std::string::npos);
+      return;
+    }
+  }
+}
+
 }  // namespace nfc
 }  // namespace esphome
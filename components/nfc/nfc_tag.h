@@ -27,30 +27,41 @@ class NfcTag {
   NfcTag(std::vector<uint8_t> &uid, const std::string &tag_type, std::unique_ptr<nfc::NdefMessage> ndef_message) {
     this->uid_ = uid;
     this->tag_type_ = tag_type;
-    this->ndef_message_ = std::move(ndef_message);
+    this->set_ndef_message(std::move(ndef_message));
   };
   NfcTag(std::vector<uint8_t> &uid, const std::string &tag_type, std::vector<uint8_t> &ndef_data) {
     this->uid_ = uid;
     this->tag_type_ = tag_type;
-    this->ndef_message_ = make_unique<NdefMessage>(ndef_data);
+    this->set_ndef_message(make_unique<NdefMessage>(ndef_data));
   };
   NfcTag(const NfcTag &rhs) {
     uid_ = rhs.uid_;
     tag_type_ = rhs.tag_type_;
     if (rhs.ndef_message_ != nullptr)
       ndef_message_ = make_unique<NdefMessage>(*rhs.ndef_message_);
+    ha_tag_id_ = rhs.ha_tag_id_;
   }
 
   std::vector<uint8_t> &get_uid() { return this->uid_; };
   const std::string &get_tag_type() { return this->tag_type_; };
   bool has_ndef_message() { return this->ndef_message_ != nullptr; };
   const std::shared_ptr<NdefMessage> &get_ndef_message() { return this->ndef_message_; };
-  void set_ndef_message(std::unique_ptr<NdefMessage> ndef_message) { this->ndef_message_ = std::move(ndef_message); };
+  void set_ndef_message(std::unique_ptr<NdefMessage> ndef_message) {
+    this->ndef_message_ = std::move(ndef_message);
+    this->derive_ha_tag_id_();
+  };
+
+  /// Home Assistant tag ID: what follows HA_TAG_ID_PREFIX in the first record containing it, empty if there is none.
+  /// Derived when the NDEF message is set; a message changed through get_ndef_message() afterwards is not reflected.
+  const std::string &get_ha_tag_id() const { return this->ha_tag_id_; };
 
  protected:
+  void derive_ha_tag_id_();
+
   std::vector<uint8_t> uid_;
   std::string tag_type_;
   std::shared_ptr<NdefMessage> ndef_message_;
+  std::string ha_tag_id_;
 };
 
 }  // namespace nfc
@@ -0,0 +1,92 @@
+#include "tag_memory.h"
+#include "esphome/core/log.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+
+namespace esphome {
+namespace nfc {
+
+static const char *const TAG = "nfc.tag_memory";
+
+bool TagMemory::read(const uint32_t address, uint8_t *data, const uint32_t length) {
+  if (address > this->size_ || length > this->size_ - address) {
+    ESP_LOGV(TAG, "Read of %" PRIu32 " bytes at %" PRIu32 " is outside the %" PRIu32 " byte NDEF area", length, address,
+             this->size_);
+    return false;
+  }
+  if (this->view_ != nullptr) {
+    std::memcpy(data, this->view_ + address, length);
+    return true;
+  }
+
+  for (uint32_t done = 0; done < length;) {
+    const uint32_t unit = (address + done) / this->unit_size_;
+    if ((unit >= this->cached_.size() || !this->cached_[unit]) && !this->fetch_unit_(unit)) {
+      return false;
+    }
+    const uint32_t offset = (address + done) % this->unit_size_;
+    const uint32_t count = std::min<uint32_t>(length - done, this->unit_size_ - offset);
+    std::memcpy(data + done, this->cache_.data() + unit * this->unit_size_ + offset, count);
+    done += count;
+  }
+  return true;
+}
+
+bool TagMemory::read(const uint32_t address, const uint32_t length, std::vector<uint8_t> &data) {
+  const size_t start = data.size();
+  data.resize(start + length);
+  if (!this->read(address, data.data() + start, length)) {
+    data.resize(start);
+    return false;
+  }
+  return true;
+}
+
+bool TagMemory::read(const uint32_t address, const uint32_t length, std::string &data) {
+  data.resize(length);
+  return length == 0 || this->read(address, reinterpret_cast<uint8_t *>(&data[0]), length);
+}
+
+void TagMemory::invalidate() {
+  this->cache_.clear();
+  this->cached_.clear();
+}
+
+void TagMemory::invalidate(const uint32_t address, const uint32_t length) {
+  if (this->view_ != nullptr || length == 0) {
+    return;
+  }
+  const uint32_t last = (address + length - 1) / this->unit_size_;
+  for (uint32_t unit = address / this->unit_size_; unit <= last && unit < this->cached_.size(); unit++) {
+    this->cached_[unit] = false;
+  }
+}
+
+bool TagMemory::fetch_unit_(const uint32_t unit) {
+  std::vector<uint8_t> data;
+  if (!this->fetch_(unit, data)) {
+    ESP_LOGV(TAG, "Failed to fetch unit %" PRIu32, unit);
+    return false;
+  }
+  // only the last unit may come up short, and only by what lies past the end of the area
+  const uint32_t start = unit * this->unit_size_;
+  const uint32_t expected = std::min<uint32_t>(this->unit_size_, this->size_ - start);
+  if (data.size() < expected) {
+    ESP_LOGV(TAG, "Unit %" PRIu32 " returned %zu of %" PRIu32 " bytes", unit, data.size(), expected);
+    return false;
+  }
+
+  if (this->cache_.size() < start + this->unit_size_) {
+    this->cache_.resize(start + this->unit_size_);
+    this->cached_.resize(unit + 1, false);
+  }
+  std::memcpy(this->cache_.data() + start, data.data(), std::min<size_t>(data.size(), this->unit_size_));
+  this->cached_[unit] = true;
+  this->fetch_count_++;
+  return true;
+}
+
+}  // namespace nfc
+}  // namespace esphome
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "esphome/core/helpers.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace nfc {
+
+/// NDEF area of a tag as one linear address space. Bytes are fetched from the tag on demand, one unit (a
+/// Classic block, a group of Type 2 pages, a Type 4 READ BINARY) at a time, and kept for as long as this object
+/// lives, so a TagMemory should be made per tag selection and dropped with it.
+class TagMemory {
+ public:
+  /// Appends unit `unit` (unit_size bytes, or fewer for the last one) to `data`
+  using FetchFunction = std::function<bool(uint32_t unit, std::vector<uint8_t> &data)>;
+
+  TagMemory(uint32_t size, uint16_t unit_size, FetchFunction fetch)
+      : size_(size), unit_size_(unit_size), fetch_(std::move(fetch)) {}
+  /// View over bytes that are already in RAM; nothing is fetched or copied
+  TagMemory(const uint8_t *data, uint32_t size) : size_(size), unit_size_(0), view_(data) {}
+
+  uint32_t size() const { return this->size_; }
+  /// Number of units fetched from the tag so far
+  uint32_t get_fetch_count() const { return this->fetch_count_; }
+
+  bool read(uint32_t address, uint8_t *data, uint32_t length);
+  /// Appends `length` bytes starting at `address` to `data`
+  bool read(uint32_t address, uint32_t length, std::vector<uint8_t> &data);
+  bool read(uint32_t address, uint32_t length, std::string &data);
+  bool read_byte(uint32_t address, uint8_t &value) { return this->read(address, &value, 1); }
+
+  /// Forget everything fetched, e.g. after the tag was written
+  void invalidate();
+  /// Forget the units covering [address, address + length), so the next read fetches them from the tag again
+  void invalidate(uint32_t address, uint32_t length);
+
+ protected:
+  bool fetch_unit_(uint32_t unit);
+
+  uint32_t size_;
+  uint16_t unit_size_;
+  FetchFunction fetch_;
+  const uint8_t *view_{nullptr};
+  std::vector<uint8_t> cache_;
+  std::vector<bool> cached_;
+  uint32_t fetch_count_{0};
+};
+
+}  // namespace nfc
+}  // namespace esphome
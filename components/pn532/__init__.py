@@ -1,28 +1,88 @@
 from esphome import automation
 import esphome.codegen as cg
 from esphome.components import nfc
+from esphome.components.nfc.binary_sensor import validate_uid
 import esphome.config_validation as cv
 from esphome.const import (
     CONF_ID,
     CONF_ON_FINISHED_WRITE,
     CONF_ON_TAG,
     CONF_ON_TAG_REMOVED,
+    CONF_PASSWORD,
     CONF_TRIGGER_ID,
 )
+from esphome.core import CORE, HexInt
 
 CODEOWNERS = ["@OttoWinter", "@jesserockz"]
 AUTO_LOAD = ["binary_sensor", "nfc"]
 MULTI_CONF = True
 
+CONF_DEEP_SLEEP = "deep_sleep"
+CONF_ON_READY_FOR_SLEEP = "on_ready_for_sleep"
+CONF_PACK = "pack"
 CONF_PN532_ID = "pn532_id"
+CONF_POLLING_IDLE_INTERVAL = "polling_idle_interval"
+CONF_POLLING_TECHNOLOGIES = "polling_technologies"
+CONF_RF_FIELD = "rf_field"
+CONF_TAG_TYPES = "tag_types"
+CONF_UID_PREFIX = "uid_prefix"
+CONF_ULTRALIGHT_PASSWORDS = "ultralight_passwords"
+CONF_WRITE_SUPPORT = "write_support"
 
 pn532_ns = cg.esphome_ns.namespace("pn532")
-PN532 = pn532_ns.class_("PN532", cg.PollingComponent)
+PN532 = pn532_ns.class_("PN532", nfc.Nfcc, cg.PollingComponent)
+
+# RF technology -> InListPassiveTarget BrTy; one is polled per update, favouring those that found tags recently
+POLLING_TECHNOLOGIES = {
+    "iso14443a": 0x00,
+    "felica_212": 0x01,
+    "felica_424": 0x02,
+    "iso14443b": 0x03,
+    "jewel": 0x04,
+}
+
+PN532RfFieldPolicy = pn532_ns.enum("PN532RfFieldPolicy")
+RF_FIELD_POLICIES = {
+    "always_off": PN532RfFieldPolicy.RF_FIELD_ALWAYS_OFF,
+    "while_present": PN532RfFieldPolicy.RF_FIELD_WHILE_PRESENT,
+    "burst": PN532RfFieldPolicy.RF_FIELD_BURST,
+}
+
+# tag type -> define compiling its reader in; other tags are still reported by UID
+TAG_TYPES = {
+    "mifare_classic": "USE_PN532_MIFARE_CLASSIC",
+    "mifare_ultralight": "USE_PN532_MIFARE_ULTRALIGHT",
+    "type4": "USE_PN532_TYPE4",
+    "felica": "USE_PN532_FELICA",
+    "type1": "USE_PN532_TYPE1",
+}
+# technologies that can only ever find a tag whose reader is one of these
+TECHNOLOGY_TAG_TYPES = {
+    "iso14443a": ["mifare_classic", "mifare_ultralight", "type4"],
+    "felica_212": ["felica"],
+    "felica_424": ["felica"],
+    "iso14443b": ["type4"],
+    "jewel": ["type1"],
+}
+
+# the longest matching prefix picks the password: a whole UID for one tag, the
+# manufacturer byte for a vendor, or no prefix for every tag
+ULTRALIGHT_PASSWORD_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_UID_PREFIX, default=""): cv.Any(cv.one_of(""), validate_uid),
+        cv.Required(CONF_PASSWORD): cv.hex_uint32_t,
+        cv.Optional(CONF_PACK): cv.hex_uint16_t,
+    }
+)
 
 PN532OnFinishedWriteTrigger = pn532_ns.class_(
     "PN532OnFinishedWriteTrigger", automation.Trigger.template()
 )
 
+PN532OnReadyForSleepTrigger = pn532_ns.class_(
+    "PN532OnReadyForSleepTrigger", automation.Trigger.template()
+)
+
 PN532IsWritingCondition = pn532_ns.class_(
     "PN532IsWritingCondition", automation.Condition
 )
@@ -30,6 +90,24 @@ PN532IsWritingCondition = pn532_ns.class_(
 PN532_SCHEMA = cv.Schema(
     {
         cv.GenerateID(): cv.declare_id(PN532),
+        cv.Optional(CONF_POLLING_TECHNOLOGIES, default=["iso14443a"]): cv.All(
+            cv.ensure_list(cv.one_of(*POLLING_TECHNOLOGIES, lower=True)),
+            cv.Length(min=1),
+        ),
+        cv.Optional(CONF_TAG_TYPES, default=list(TAG_TYPES)): cv.All(
+            cv.ensure_list(cv.one_of(*TAG_TYPES, lower=True)),
+            cv.Length(min=1),
+        ),
+        cv.Optional(CONF_WRITE_SUPPORT, default=True): cv.boolean,
+        cv.Optional(CONF_ULTRALIGHT_PASSWORDS): cv.ensure_list(
+            ULTRALIGHT_PASSWORD_SCHEMA
+        ),
+        cv.Optional(CONF_POLLING_IDLE_INTERVAL, default=4): cv.int_range(
+            min=1, max=255
+        ),
+        cv.Optional(CONF_RF_FIELD, default="always_off"): cv.enum(
+            RF_FIELD_POLICIES, lower=True
+        ),
         cv.Optional(CONF_ON_TAG): automation.validate_automation(
             {
                 cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(nfc.NfcOnTagTrigger),
@@ -47,10 +125,58 @@ PN532_SCHEMA = cv.Schema(
                 cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(nfc.NfcOnTagTrigger),
             }
         ),
+        # keep the tag state in RTC memory, so a wake from deep sleep skips what is done
+        cv.Optional(CONF_DEEP_SLEEP, default=False): cv.boolean,
+        cv.Optional(CONF_ON_READY_FOR_SLEEP): automation.validate_automation(
+            {
+                cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(
+                    PN532OnReadyForSleepTrigger
+                ),
+            }
+        ),
     }
 ).extend(cv.polling_component_schema("1s"))
 
 
+def validate_pn532(config):
+    tag_types = config[CONF_TAG_TYPES]
+    for technology in config[CONF_POLLING_TECHNOLOGIES]:
+        if not any(t in tag_types for t in TECHNOLOGY_TAG_TYPES[technology]):
+            raise cv.Invalid(
+                f"Polling {technology} needs one of the tag types "
+                f"{', '.join(TECHNOLOGY_TAG_TYPES[technology])}",
+                path=[CONF_TAG_TYPES],
+            )
+    if CONF_ULTRALIGHT_PASSWORDS in config and "mifare_ultralight" not in tag_types:
+        raise cv.Invalid(
+            f"{CONF_ULTRALIGHT_PASSWORDS} requires the mifare_ultralight tag type",
+            path=[CONF_ULTRALIGHT_PASSWORDS],
+        )
+    if config[CONF_WRITE_SUPPORT]:
+        if "mifare_classic" not in tag_types and "mifare_ultralight" not in tag_types:
+            raise cv.Invalid(
+                "Writing needs the mifare_classic or mifare_ultralight tag type",
+                path=[CONF_WRITE_SUPPORT],
+            )
+    elif CONF_ON_FINISHED_WRITE in config:
+        raise cv.Invalid(
+            f"{CONF_ON_FINISHED_WRITE} requires {CONF_WRITE_SUPPORT}",
+            path=[CONF_ON_FINISHED_WRITE],
+        )
+    if config[CONF_DEEP_SLEEP]:
+        if not CORE.is_esp32:
+            raise cv.Invalid(
+                f"{CONF_DEEP_SLEEP} is only supported on ESP32",
+                path=[CONF_DEEP_SLEEP],
+            )
+    elif CONF_ON_READY_FOR_SLEEP in config:
+        raise cv.Invalid(
+            f"{CONF_ON_READY_FOR_SLEEP} requires {CONF_DEEP_SLEEP}",
+            path=[CONF_ON_READY_FOR_SLEEP],
+        )
+    return config
+
+
 def CONFIG_SCHEMA(conf):
     if conf:
         raise cv.Invalid(
@@ -62,6 +188,28 @@ def CONFIG_SCHEMA(conf):
 async def setup_pn532(var, config):
     await cg.register_component(var, config)
 
+    for tag_type in config[CONF_TAG_TYPES]:
+        cg.add_define(TAG_TYPES[tag_type])
+    if config[CONF_WRITE_SUPPORT]:
+        cg.add_define("USE_PN532_WRITE")
+    if config[CONF_DEEP_SLEEP]:
+        cg.add_define("USE_PN532_DEEP_SLEEP")
+
+    for technology in config[CONF_POLLING_TECHNOLOGIES]:
+        cg.add(var.add_polling_technology(POLLING_TECHNOLOGIES[technology]))
+    cg.add(var.set_polling_idle_interval(config[CONF_POLLING_IDLE_INTERVAL]))
+    cg.add(var.set_rf_field_policy(config[CONF_RF_FIELD]))
+    for conf in config.get(CONF_ULTRALIGHT_PASSWORDS, []):
+        prefix = conf[CONF_UID_PREFIX]
+        prefix = [HexInt(int(x, 16)) for x in prefix.split("-")] if prefix else []
+        password = HexInt(conf[CONF_PASSWORD])
+        if CONF_PACK in conf:
+            cg.add(
+                var.add_ultralight_password(prefix, password, HexInt(conf[CONF_PACK]))
+            )
+        else:
+            cg.add(var.add_ultralight_password(prefix, password))
+
     for conf in config.get(CONF_ON_TAG, []):
         trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID])
         cg.add(var.register_ontag_trigger(trigger))
@@ -80,6 +228,10 @@ async def setup_pn532(var, config):
         trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
         await automation.build_automation(trigger, [], conf)
 
+    for conf in config.get(CONF_ON_READY_FOR_SLEEP, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(trigger, [], conf)
+
 
 @automation.register_condition(
     "pn532.is_writing",
@@ -1,9 +1,21 @@
 #include "pn532.h"
 
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
 #include <memory>
 #include "esphome/core/log.h"
 #include "esphome/core/hal.h"
 
+#ifdef USE_PN532_DEEP_SLEEP
+#include <esp_attr.h>
+#endif
+#ifdef USE_PN532_MEMORY_STATS
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
 // Based on:
 // - https://cdn-shop.adafruit.com/datasheets/PN532C106_Application+Note_v1.2.pdf
 // - https://www.nxp.com/docs/en/nxp/application-notes/AN133910.pdf
@@ -14,8 +26,91 @@ namespace pn532 {
 
 static const char *const TAG = "pn532";
 
+static const char *rf_field_policy_to_string(const PN532RfFieldPolicy policy) {
+  switch (policy) {
+    case RF_FIELD_ALWAYS_OFF:
+      return "off between polls";
+    case RF_FIELD_WHILE_PRESENT:
+      return "on while a tag is present";
+    case RF_FIELD_BURST:
+      return "on during bursts";
+    default:
+      return "unknown";
+  }
+}
+
+static const char *read_outcome_to_string(const PN532ReadOutcome outcome) {
+  switch (outcome) {
+    case READ_OUTCOME_COMPLETE:
+      return "complete";
+    case READ_OUTCOME_PARTIAL:
+      return "partial";
+    case READ_OUTCOME_FAILED:
+      return "failed";
+    default:
+      return "unknown";
+  }
+}
+
+#ifdef USE_PN532_MEMORY_STATS
+static const char *operation_to_string(const PN532Operation operation) {
+  switch (operation) {
+    case OPERATION_READ:
+      return "Read";
+    case OPERATION_WRITE:
+      return "Write";
+    case OPERATION_TRIGGERS:
+      return "Triggers";
+    default:
+      return "Unknown";
+  }
+}
+
+static MemorySample sample_memory() {
+  return {
+      static_cast<uint32_t>(heap_caps_get_free_size(MALLOC_CAP_8BIT)),
+      static_cast<uint32_t>(heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT)),
+      // ESP-IDF counts the high-water mark in bytes
+      static_cast<uint32_t>(uxTaskGetStackHighWaterMark(nullptr)),
+  };
+}
+#endif
+
+#ifdef USE_PN532_DEEP_SLEEP
+// RTC slow memory survives deep sleep and is zeroed by every other reset; each instance claims a slot in setup order
+static RTC_DATA_ATTR PN532RetainedState retained_states[PN532_MAX_RETAINED_STATES];
+static uint8_t retained_states_claimed = 0;
+
+static uint32_t ndef_content_hash(nfc::NfcTag &tag) {
+  if (!tag.has_ndef_message())
+    return 0;
+  const auto encoded = tag.get_ndef_message()->encode();
+  return fnv1_hash(std::string(encoded.begin(), encoded.end()));
+}
+#endif
+
 void PN532::setup() {
   ESP_LOGCONFIG(TAG, "Running setup");
+  if (this->polling_technologies_.empty()) {
+    this->add_polling_technology(PN532_BRTY_ISO14443A);
+  }
+
+#ifdef USE_PN532_DEEP_SLEEP
+  if (retained_states_claimed < PN532_MAX_RETAINED_STATES) {
+    this->retained_state_ = &retained_states[retained_states_claimed++];
+  }
+  if (this->retained_state_ != nullptr && this->retained_state_->configured) {
+    // the chip kept its configuration through the power down in on_shutdown(); the first command may only wake it
+    ESP_LOGD(TAG, "Woke from deep sleep, skipping chip detection");
+    this->restore_retained_state_();
+    if (this->configure_sam_() || this->configure_sam_()) {
+      this->turn_off_rf_();
+      return;
+    }
+    ESP_LOGW(TAG, "PN532 did not answer after deep sleep, running full setup");
+    *this->retained_state_ = {};
+  }
+#endif
 
   // Get version data
   if (!this->write_command_({PN532_COMMAND_VERSION_DATA})) {
@@ -54,6 +149,20 @@ void PN532::setup() {
     return;
   }
 
+  if (!this->configure_sam_()) {
+    this->error_code_ = SAM_COMMAND_FAILED;
+    this->mark_failed();
+    return;
+  }
+#ifdef USE_PN532_DEEP_SLEEP
+  if (this->retained_state_ != nullptr)
+    this->retained_state_->configured = true;
+#endif
+
+  this->turn_off_rf_();
+}
+
+bool PN532::configure_sam_() {
   // Set up SAM (secure access module)
   uint8_t sam_timeout = std::min<uint8_t>(255u, this->update_interval_ / 50);
   if (!this->write_command_({
@@ -62,9 +171,7 @@ void PN532::setup() {
           sam_timeout,  // timeout as multiple of 50ms (actually only for virtual card mode, but shouldn't matter)
           0x01,         // Enable IRQ
       })) {
-    this->error_code_ = SAM_COMMAND_FAILED;
-    this->mark_failed();
-    return;
+    return false;
   }
 
   std::vector<uint8_t> sam_result;
@@ -73,12 +180,9 @@ void PN532::setup() {
     for (uint8_t dat : sam_result) {
       ESP_LOGV(TAG, " 0x%02X", dat);
     }
-    this->error_code_ = SAM_COMMAND_FAILED;
-    this->mark_failed();
-    return;
+    return false;
   }
-
-  this->turn_off_rf_();
+  return true;
 }
 
 bool PN532::powerdown() {
@@ -107,14 +211,32 @@ void PN532::update() {
   if (!updates_enabled_)
     return;
 
-  for (auto *obj : this->binary_sensors_)
-    obj->on_scan_end();
+  this->polling_cycle_++;
+  auto &technology = this->select_polling_technology_();
+  technology.polls++;
+  technology.last_polled = this->polling_cycle_;
+  this->poll_brty_ = technology.brty;
+  if (this->polling_cycle_ % PN532_POLL_STATS_LOG_CYCLES == 0) {
+    this->log_polling_stats_();
+#ifdef USE_PN532_MEMORY_STATS
+    this->log_memory_stats_();
+#endif
+  }
 
-  if (!this->write_command_({
-          PN532_COMMAND_INLISTPASSIVETARGET,
-          0x01,  // max 1 card
-          0x00,  // baud rate ISO14443A (106 kbit/s)
-      })) {
+  std::vector<uint8_t> command = {
+      PN532_COMMAND_INLISTPASSIVETARGET,
+      0x01,  // max 1 card
+      this->poll_brty_,
+  };
+  if (this->poll_brty_ == PN532_BRTY_FELICA_212 || this->poll_brty_ == PN532_BRTY_FELICA_424) {
+    // FeliCa polling request for the NDEF system code, no request data, a single time slot
+    command.insert(command.end(), {nfc::FELICA_CMD_POLLING, nfc::FELICA_NDEF_SYSTEM_CODE >> 8,
+                                   nfc::FELICA_NDEF_SYSTEM_CODE & 0xFF, 0x00, 0x00});
+  } else if (this->poll_brty_ == PN532_BRTY_ISO14443B) {
+    command.push_back(0x00);  // AFI: all application families
+  }
+
+  if (!this->write_command_(command)) {
     ESP_LOGW(TAG, "Requesting tag read failed!");
     this->status_set_warning();
     return;
@@ -142,72 +264,158 @@ void PN532::loop() {
 
   this->requested_read_ = false;
 
+  const bool felica = this->poll_brty_ == PN532_BRTY_FELICA_212 || this->poll_brty_ == PN532_BRTY_FELICA_424;
+  const bool type_b = this->poll_brty_ == PN532_BRTY_ISO14443B;
+  const bool jewel = this->poll_brty_ == PN532_BRTY_JEWEL;
   if (!success) {
     // Something failed
-    if (!this->current_uid_.empty()) {
-      auto tag = make_unique<nfc::NfcTag>(this->current_uid_);
-      for (auto *trigger : this->triggers_ontagremoved_)
-        trigger->process(tag);
-    }
-    this->current_uid_ = {};
-    this->turn_off_rf_();
+    this->handle_empty_poll_();
     return;
   }
 
   uint8_t num_targets = read[0];
   if (num_targets != 1) {
     // no tags found or too many
-    if (!this->current_uid_.empty()) {
-      auto tag = make_unique<nfc::NfcTag>(this->current_uid_);
-      for (auto *trigger : this->triggers_ontagremoved_)
-        trigger->process(tag);
-    }
-    this->current_uid_ = {};
-    this->turn_off_rf_();
+    this->handle_empty_poll_();
     return;
   }
 
-  uint8_t nfcid_length = read[5];
-  std::vector<uint8_t> nfcid(read.begin() + 6, read.begin() + 6 + nfcid_length);
-  if (read.size() < 6U + nfcid_length) {
-    // oops, pn532 returned invalid data
-    return;
-  }
-
-  bool report = true;
-  for (auto *bin_sens : this->binary_sensors_) {
-    if (bin_sens->process(nfcid)) {
-      report = false;
+  const uint32_t detected = millis();
+  this->empty_polls_ = 0;
+  for (auto &technology : this->polling_technologies_) {
+    if (technology.brty == this->poll_brty_) {
+      technology.hits++;
+      technology.last_hit = this->polling_cycle_;
     }
   }
 
-  if (nfcid.size() == this->current_uid_.size()) {
-    bool same_uid = true;
-    for (size_t i = 0; i < nfcid.size(); i++)
-      same_uid &= nfcid[i] == this->current_uid_[i];
-    if (same_uid)
+  std::vector<uint8_t> nfcid;
+  if (type_b) {
+    // type B targets have no UID; the PUPI from ATQB identifies them
+    if (read.size() < PN532_ISO14443B_PUPI_OFFSET + PN532_ISO14443B_PUPI_SIZE) {
+      return;
+    }
+    nfcid.assign(read.begin() + PN532_ISO14443B_PUPI_OFFSET,
+                 read.begin() + PN532_ISO14443B_PUPI_OFFSET + PN532_ISO14443B_PUPI_SIZE);
+  } else if (jewel) {
+    if (read.size() < PN532_JEWEL_ID_OFFSET + PN532_JEWEL_ID_SIZE) {
+      return;
+    }
+    nfcid.assign(read.begin() + PN532_JEWEL_ID_OFFSET, read.begin() + PN532_JEWEL_ID_OFFSET + PN532_JEWEL_ID_SIZE);
+  } else if (felica) {
+    // the IDm takes the place of the UID
+    if (read.size() < PN532_FELICA_IDM_OFFSET + nfc::FELICA_IDM_SIZE) {
       return;
+    }
+    nfcid.assign(read.begin() + PN532_FELICA_IDM_OFFSET,
+                 read.begin() + PN532_FELICA_IDM_OFFSET + nfc::FELICA_IDM_SIZE);
+  } else {
+    if (read.size() < 6U || read.size() < 6U + read[5]) {
+      // oops, pn532 returned invalid data
+      return;
+    }
+    nfcid.assign(read.begin() + 6, read.begin() + 6 + read[5]);
   }
 
-  this->current_uid_ = nfcid;
+  if (this->current_tag_ != nullptr && this->current_tag_->get_uid() == nfcid) {
+    this->finish_poll_(true);
+    return;
+  }
+  // a different tag replaced the one we knew about without an empty scan in between
+  this->report_tag_removed_();
+  this->current_tag_brty_ = this->poll_brty_;
+  // a password accepted by a tag only holds until it is next activated
+  this->ultralight_authenticated_ = false;
+  this->ultralight_config_read_ = false;
+  this->ultralight_capacity_read_ = false;
+
+  if ((felica || type_b || jewel) && next_task_ != READ) {
+    ESP_LOGE(TAG, "Only reading is supported for FeliCa, ISO14443B and Type 1 tags");
+    this->read_mode();
+  }
 
   if (next_task_ == READ) {
-    auto tag = this->read_tag_(nfcid);
+    this->read_telemetry_ = {};
+#ifdef USE_PN532_MEMORY_STATS
+    const auto read_memory = sample_memory();
+#endif
+    // every activation starts out at 106 kbit/s; ISO-DEP targets may be able to go faster for the actual read
+    this->bit_rate_ = PN532_BIT_RATE_106;
+    std::unique_ptr<nfc::NfcTag> tag;
+    if (felica) {
+#ifdef USE_PN532_FELICA
+      tag = this->read_felica_tag_(nfcid);
+#endif
+    } else if (jewel) {
+#ifdef USE_PN532_TYPE1
+      tag = this->read_type1_tag_(nfcid);
+#endif
+    } else if (type_b) {
+#ifdef USE_PN532_TYPE4
+      // the PN532 has already sent ATTRIB, so the target speaks ISO-DEP
+      tag = this->read_type4_tag_(nfcid);
+#endif
+    } else {
+#ifdef USE_PN532_TYPE4
+      if (read[4] & nfc::ISO14443_4_SEL_RES_MASK) {
+        this->negotiate_bit_rate_(nfcid, std::vector<uint8_t>(read.begin() + 6 + nfcid.size(), read.end()));
+      }
+#endif
+      tag = this->read_tag_(nfcid, read[4]);
+    }
+    // technologies whose reader is not compiled in still report their UID
+    if (tag == nullptr)
+      tag = make_unique<nfc::NfcTag>(nfcid);
+#ifdef USE_PN532_MEMORY_STATS
+    this->record_memory_stats_(OPERATION_READ, read_memory);
+#endif
+    this->finish_read_telemetry_(*tag, detected);
+#ifdef USE_PN532_DEEP_SLEEP
+    // only the whole message tells whether anything changed: a meter keeps its header while its reading moves on
+    const uint32_t content_hash = ndef_content_hash(*tag);
+    if (this->is_retained_tag_(nfcid, content_hash)) {
+      // it was reported before the last deep sleep; listeners and triggers would only publish the same again
+      ESP_LOGD(TAG, "Tag '%s' unchanged since before deep sleep", nfc::format_uid(nfcid).c_str());
+      this->current_tag_ = std::move(tag);
+      this->finish_poll_(true);
+      this->ready_for_sleep_();
+      return;
+    }
+#endif
+    ESP_LOGD(TAG, "Found new tag '%s'", nfc::format_uid(nfcid).c_str());
+    if (tag->has_ndef_message()) {
+      const auto &message = tag->get_ndef_message();
+      const auto &records = message->get_records();
+      ESP_LOGD(TAG, "  NDEF formatted records:");
+      for (const auto &record : records) {
+        ESP_LOGD(TAG, "    %s - %s", record->get_type().c_str(), record->get_payload().c_str());
+      }
+    }
+
+#ifdef USE_PN532_MEMORY_STATS
+    const auto triggers_memory = sample_memory();
+#endif
+    // the tag is decoded once; every listener matches against this same copy
+    for (auto *listener : this->tag_listeners_)
+      listener->tag_on(*tag);
     for (auto *trigger : this->triggers_ontag_)
       trigger->process(tag);
+#ifdef USE_PN532_MEMORY_STATS
+    this->record_memory_stats_(OPERATION_TRIGGERS, triggers_memory);
+#endif
+    this->current_tag_ = std::move(tag);
+#ifdef USE_PN532_DEEP_SLEEP
+    this->retain_tag_(nfcid, content_hash);
+#endif
+  } else {
+    // the tag is not read while cleaning/formatting/writing; listeners only get to see its UID
+    this->current_tag_ = make_unique<nfc::NfcTag>(nfcid);
+    for (auto *listener : this->tag_listeners_)
+      listener->tag_on(*this->current_tag_);
+  }
 
-    if (report) {
-      ESP_LOGD(TAG, "Found new tag '%s'", nfc::format_uid(nfcid).c_str());
-      if (tag->has_ndef_message()) {
-        const auto &message = tag->get_ndef_message();
-        const auto &records = message->get_records();
-        ESP_LOGD(TAG, "  NDEF formatted records:");
-        for (const auto &record : records) {
-          ESP_LOGD(TAG, "    %s - %s", record->get_type().c_str(), record->get_payload().c_str());
-        }
-      }
-    }
-  } else if (next_task_ == CLEAN) {
+#ifdef USE_PN532_WRITE
+  if (next_task_ == CLEAN) {
     ESP_LOGD(TAG, "  Tag cleaning");
     if (!this->clean_tag_(nfcid)) {
       ESP_LOGE(TAG, "  Tag was not fully cleaned successfully");
@@ -227,9 +435,15 @@ void PN532::loop() {
         ESP_LOGE(TAG, "  Tag could not be formatted for writing");
       } else {
         ESP_LOGD(TAG, "  Writing NDEF data");
+#ifdef USE_PN532_MEMORY_STATS
+        const auto write_memory = sample_memory();
+#endif
         if (!this->write_tag_(nfcid, this->next_task_message_to_write_)) {
           ESP_LOGE(TAG, "  Failed to write message to tag");
         }
+#ifdef USE_PN532_MEMORY_STATS
+        this->record_memory_stats_(OPERATION_WRITE, write_memory);
+#endif
         ESP_LOGD(TAG, "  Finished writing NDEF data");
         delete this->next_task_message_to_write_;
         this->next_task_message_to_write_ = nullptr;
@@ -237,10 +451,14 @@ void PN532::loop() {
       }
     }
   }
+#endif
 
   this->read_mode();
 
-  this->turn_off_rf_();
+  this->finish_poll_(true);
+#ifdef USE_PN532_DEEP_SLEEP
+  this->ready_for_sleep_();
+#endif
 }
 
 bool PN532::write_command_(const std::vector<uint8_t> &data) {
@@ -275,19 +493,23 @@ bool PN532::write_command_(const std::vector<uint8_t> &data) {
   // Postamble
   write_data.push_back(0x00);
 
-  this->write_data(write_data);
+  this->read_telemetry_.exchanges++;
+  const uint32_t start = micros();
+  std::vector<uint8_t> ack;
+  if (!this->write_data_read_ack(write_data, ack)) {
+    ESP_LOGV(TAG, "No ACK for command 0x%02X", write_data[6]);
+    return false;
+  }
+  ESP_LOGV(TAG, "Command 0x%02X acknowledged after %" PRIu32 " us", write_data[6], micros() - start);
 
-  return this->read_ack_();
+  return this->is_ack_(ack);
 }
 
-bool PN532::read_ack_() {
-  ESP_LOGV(TAG, "Reading ACK");
-
-  std::vector<uint8_t> data;
-  if (!this->read_data(data, 6)) {
-    return false;
-  }
+bool PN532::write_data_read_ack(const std::vector<uint8_t> &data, std::vector<uint8_t> &ack) {
+  return this->write_data(data) && this->read_data(ack, 6);
+}
 
+bool PN532::is_ack_(const std::vector<uint8_t> &data) {
   bool matches = (data[1] == 0x00 &&                     // preamble
                   data[2] == 0x00 &&                     // start of packet
                   data[3] == 0xFF && data[4] == 0x00 &&  // ACK packet code
@@ -307,11 +529,15 @@ void PN532::send_nack_() {
   delay(10);
 }
 
+void PN532::clear_read_ready_() {
+  this->rd_start_time_ = 0;
+  this->rd_ready_ = WOULDBLOCK;
+}
+
 enum PN532ReadReady PN532::read_ready_(bool block) {
   if (this->rd_ready_ == READY) {
     if (block) {
-      this->rd_start_time_ = 0;
-      this->rd_ready_ = WOULDBLOCK;
+      this->clear_read_ready_();
     }
     return READY;
   }
@@ -342,8 +568,7 @@ enum PN532ReadReady PN532::read_ready_(bool block) {
 
   auto rdy = this->rd_ready_;
   if (block || rdy == TIMEOUT) {
-    this->rd_start_time_ = 0;
-    this->rd_ready_ = WOULDBLOCK;
+    this->clear_read_ready_();
   }
   return rdy;
 }
@@ -355,22 +580,104 @@ void PN532::turn_off_rf_() {
       0x01,  // RF Field
       0x00,  // Off
   });
+  this->rf_field_kept_on_ = false;
+}
+
+void PN532::handle_empty_poll_() {
+  if (this->empty_polls_ < UINT8_MAX)
+    this->empty_polls_++;
+  // a tag only counts as gone once the technology it answered to has been polled without finding it
+  if (this->current_tag_ != nullptr && this->current_tag_brty_ == this->poll_brty_) {
+    if (this->rf_field_kept_on_) {
+      // a target released under a live field may be halted (ISO-DEP ones are, by the DESELECT) and ignore REQA;
+      // it is only gone once a poll with a freshly raised field misses it too
+      ESP_LOGV(TAG, "Tag did not answer under the kept field, confirming with a fresh one");
+      this->turn_off_rf_();
+      return;
+    }
+    this->report_tag_removed_();
+  }
+  this->finish_poll_(false);
+#ifdef USE_PN532_DEEP_SLEEP
+  this->check_ready_for_sleep_();
+#endif
+}
+
+void PN532::finish_poll_(const bool target_active) {
+  bool keep_on = false;
+  switch (this->rf_field_policy_) {
+    case RF_FIELD_ALWAYS_OFF:
+      break;
+    case RF_FIELD_WHILE_PRESENT:
+      keep_on = this->current_tag_ != nullptr;
+      break;
+    case RF_FIELD_BURST:
+      keep_on = this->empty_polls_ < PN532_RF_BURST_EMPTY_POLLS;
+      break;
+  }
+  if (!keep_on) {
+    this->turn_off_rf_();
+    return;
+  }
+
+  if (target_active) {
+    // frees the PN532 for the next InListPassiveTarget while the tag stays powered
+    if (!this->write_command_({PN532_COMMAND_INRELEASE, 0x00})) {  // all targets
+      ESP_LOGV(TAG, "InRelease not acknowledged");
+    } else {
+      std::vector<uint8_t> response;
+      if (!this->read_response(PN532_COMMAND_INRELEASE, response) || response.empty() ||
+          (response[0] & PN532_INDATAEXCHANGE_ERROR_MASK) != 0) {
+        ESP_LOGV(TAG, "InRelease failed");
+      }
+    }
+  }
+  this->rf_field_kept_on_ = true;
 }
 
-std::unique_ptr<nfc::NfcTag> PN532::read_tag_(std::vector<uint8_t> &uid) {
+std::unique_ptr<nfc::NfcTag> PN532::read_tag_(std::vector<uint8_t> &uid, const uint8_t sel_res) {
   uint8_t type = nfc::guess_tag_type(uid.size());
 
-  if (type == nfc::TAG_TYPE_MIFARE_CLASSIC) {
+  if (sel_res & nfc::ISO14443_4_SEL_RES_MASK) {
+    // the PN532 has already sent RATS; the target only speaks ISO/IEC 7816-4 from here on
+    ESP_LOGD(TAG, "ISO/IEC 14443-4");
+#ifdef USE_PN532_TYPE4
+    return this->read_type4_tag_(uid);
+#endif
+  } else if (type == nfc::TAG_TYPE_MIFARE_CLASSIC) {
     ESP_LOGD(TAG, "Mifare classic");
+#ifdef USE_PN532_MIFARE_CLASSIC
     return this->read_mifare_classic_tag_(uid);
+#endif
   } else if (type == nfc::TAG_TYPE_2) {
     ESP_LOGD(TAG, "Mifare ultralight");
+#ifdef USE_PN532_MIFARE_ULTRALIGHT
     return this->read_mifare_ultralight_tag_(uid);
+#endif
   } else if (type == nfc::TAG_TYPE_UNKNOWN) {
     ESP_LOGV(TAG, "Cannot determine tag type");
     return make_unique<nfc::NfcTag>(uid);
-  } else {
-    return make_unique<nfc::NfcTag>(uid);
+  }
+  return make_unique<nfc::NfcTag>(uid);
+}
+
+std::unique_ptr<nfc::NdefMessage> PN532::decode_ndef_message_(nfc::TagMemory &memory, const uint32_t start,
+                                                             const uint32_t length) {
+  for (uint8_t attempt = 0;; attempt++) {
+    auto message = make_unique<nfc::NdefMessage>(memory, start, length);
+    if (this->ndef_message_is_valid_(*message)) {
+      this->read_telemetry_.ndef_size = length;
+      return message;
+    }
+    if (attempt == PN532_NDEF_REREAD_ATTEMPTS) {
+      ESP_LOGW(TAG, "NDEF message still invalid after %u re-reads, discarding it", attempt);
+      this->read_telemetry_.read_failed = true;
+      return nullptr;
+    }
+    this->read_telemetry_.retries++;
+    // only what the message occupies is fetched again; the TLVs ahead of it stay cached
+    ESP_LOGD(TAG, "NDEF message rejected, re-reading %" PRIu32 " bytes", length);
+    memory.invalidate(start, length);
   }
 }
 
@@ -378,6 +685,7 @@ void PN532::read_mode() {
   this->next_task_ = READ;
   ESP_LOGD(TAG, "Waiting to read next tag");
 }
+#ifdef USE_PN532_WRITE
 void PN532::clean_mode() {
   this->next_task_ = CLEAN;
   ESP_LOGD(TAG, "Waiting to clean next tag");
@@ -394,36 +702,52 @@ void PN532::write_mode(nfc::NdefMessage *message) {
 
 bool PN532::clean_tag_(std::vector<uint8_t> &uid) {
   uint8_t type = nfc::guess_tag_type(uid.size());
+#ifdef USE_PN532_MIFARE_CLASSIC
   if (type == nfc::TAG_TYPE_MIFARE_CLASSIC) {
     return this->format_mifare_classic_mifare_(uid);
-  } else if (type == nfc::TAG_TYPE_2) {
-    return this->clean_mifare_ultralight_();
   }
+#endif
+#ifdef USE_PN532_MIFARE_ULTRALIGHT
+  if (type == nfc::TAG_TYPE_2) {
+    return this->clean_mifare_ultralight_(uid);
+  }
+#endif
   ESP_LOGE(TAG, "Unsupported Tag for formatting");
   return false;
 }
 
 bool PN532::format_tag_(std::vector<uint8_t> &uid) {
   uint8_t type = nfc::guess_tag_type(uid.size());
+#ifdef USE_PN532_MIFARE_CLASSIC
   if (type == nfc::TAG_TYPE_MIFARE_CLASSIC) {
     return this->format_mifare_classic_ndef_(uid);
-  } else if (type == nfc::TAG_TYPE_2) {
-    return this->clean_mifare_ultralight_();
   }
+#endif
+#ifdef USE_PN532_MIFARE_ULTRALIGHT
+  if (type == nfc::TAG_TYPE_2) {
+    return this->clean_mifare_ultralight_(uid);
+  }
+#endif
   ESP_LOGE(TAG, "Unsupported Tag for formatting");
   return false;
 }
 
 bool PN532::write_tag_(std::vector<uint8_t> &uid, nfc::NdefMessage *message) {
   uint8_t type = nfc::guess_tag_type(uid.size());
+#ifdef USE_PN532_MIFARE_CLASSIC
   if (type == nfc::TAG_TYPE_MIFARE_CLASSIC) {
     return this->write_mifare_classic_tag_(uid, message);
-  } else if (type == nfc::TAG_TYPE_2) {
+  }
+#endif
+#ifdef USE_PN532_MIFARE_ULTRALIGHT
+  if (type == nfc::TAG_TYPE_2) {
     return this->write_mifare_ultralight_tag_(uid, message);
   }
+#endif
   ESP_LOGE(TAG, "Unsupported Tag for formatting");
   return false;
 }
+#endif  // USE_PN532_WRITE
 
 float PN532::get_setup_priority() const { return setup_priority::DATA; }
 
@@ -441,25 +765,235 @@ void PN532::dump_config() {
   }
 
   LOG_UPDATE_INTERVAL(this);
+  ESP_LOGCONFIG(TAG, "  Polling idle interval: %u cycles", this->polling_idle_interval_);
+  ESP_LOGCONFIG(TAG, "  RF field: %s", rf_field_policy_to_string(this->rf_field_policy_));
+  for (auto &technology : this->polling_technologies_) {
+    ESP_LOGCONFIG(TAG, "  Polling technology: BrTy 0x%02X", technology.brty);
+  }
+#ifdef USE_SENSOR
+  LOG_SENSOR("  ", "Read duration", this->read_duration_sensor_);
+  LOG_SENSOR("  ", "Bytes read", this->bytes_read_sensor_);
+  LOG_SENSOR("  ", "NDEF size", this->ndef_size_sensor_);
+  LOG_SENSOR("  ", "Over-read ratio", this->over_read_ratio_sensor_);
+  LOG_SENSOR("  ", "Reads", this->reads_sensor_);
+  LOG_SENSOR("  ", "Read size", this->read_size_sensor_);
+  LOG_SENSOR("  ", "Exchanges", this->exchanges_sensor_);
+  LOG_SENSOR("  ", "Retries", this->retries_sensor_);
+  LOG_SENSOR("  ", "Read success rate", this->read_success_rate_sensor_);
+  for (auto &technology : this->polling_technologies_) {
+    LOG_SENSOR("  ", "Polls", this->polling_sensors_[technology.brty][POLLING_POLLS]);
+    LOG_SENSOR("  ", "Poll hits", this->polling_sensors_[technology.brty][POLLING_HITS]);
+  }
+#endif
+#ifdef USE_TEXT_SENSOR
+  LOG_TEXT_SENSOR("  ", "Read outcome", this->read_outcome_text_sensor_);
+#endif
+#ifdef USE_PN532_MIFARE_ULTRALIGHT
+  ESP_LOGCONFIG(TAG, "  Ultralight passwords: %u", this->ultralight_passwords_.size());
+#endif
+#ifdef USE_PN532_DEEP_SLEEP
+  ESP_LOGCONFIG(TAG, "  Deep sleep state retained: %s", YESNO(this->retained_state_ != nullptr));
+#endif
+}
+
+PollingTechnology &PN532::select_polling_technology_() {
+  // the technology that found a tag most recently is the primary one; before any hit, the first one listed
+  auto *primary = &this->polling_technologies_.front();
+  for (auto &technology : this->polling_technologies_) {
+    if (technology.last_hit > primary->last_hit)
+      primary = &technology;
+  }
 
-  for (auto *child : this->binary_sensors_) {
-    LOG_BINARY_SENSOR("  ", "Tag", child);
+  // of the technologies that are due, poll the one that is most overdue; if none is due, the one due soonest
+  PollingTechnology *selected = nullptr;
+  int32_t selected_overdue = 0;
+  for (auto &technology : this->polling_technologies_) {
+    const bool recent =
+        technology.last_hit != 0 && this->polling_cycle_ - technology.last_hit <= PN532_POLL_RECENT_CYCLES;
+    const uint32_t interval = (&technology == primary || recent) ? 1 : this->polling_idle_interval_;
+    const int32_t overdue = int32_t(this->polling_cycle_ - technology.last_polled) - int32_t(interval);
+    if (selected == nullptr || overdue > selected_overdue) {
+      selected = &technology;
+      selected_overdue = overdue;
+    }
   }
+  return *selected;
 }
 
-bool PN532BinarySensor::process(std::vector<uint8_t> &data) {
-  if (data.size() != this->uid_.size())
-    return false;
+void PN532::log_polling_stats_() {
+  for (auto &technology : this->polling_technologies_) {
+    ESP_LOGD(TAG, "Polling BrTy 0x%02X: %" PRIu32 " hits in %" PRIu32 " polls", technology.brty, technology.hits,
+             technology.polls);
+#ifdef USE_SENSOR
+    auto **sensors = this->polling_sensors_[technology.brty];
+    if (sensors[POLLING_POLLS] != nullptr)
+      sensors[POLLING_POLLS]->publish_state(technology.polls);
+    if (sensors[POLLING_HITS] != nullptr)
+      sensors[POLLING_HITS]->publish_state(technology.hits);
+#endif
+  }
+}
 
-  for (size_t i = 0; i < data.size(); i++) {
-    if (data[i] != this->uid_[i])
-      return false;
+void PN532::count_read_(const uint16_t bytes) {
+  auto &telemetry = this->read_telemetry_;
+  telemetry.reads++;
+  telemetry.bytes_read += bytes;
+  telemetry.read_size = std::max(telemetry.read_size, bytes);
+}
+
+void PN532::finish_read_telemetry_(nfc::NfcTag &tag, const uint32_t detected) {
+  auto &telemetry = this->read_telemetry_;
+  telemetry.duration = millis() - detected;
+  if (tag.has_ndef_message() || !telemetry.read_failed) {
+    telemetry.outcome = READ_OUTCOME_COMPLETE;
+  } else {
+    telemetry.outcome = telemetry.bytes_read > 0 ? READ_OUTCOME_PARTIAL : READ_OUTCOME_FAILED;
+  }
+  this->read_history_ = (this->read_history_ << 1) | (telemetry.outcome == READ_OUTCOME_COMPLETE ? 1 : 0);
+  if (this->read_history_count_ < PN532_READ_HISTORY_SIZE)
+    this->read_history_count_++;
+
+  ESP_LOGD(TAG,
+           "Read %s in %" PRIu32 " ms: %" PRIu32 " bytes in %u reads of up to %u for a %" PRIu32
+           " byte message, %u exchanges, %u retries",
+           read_outcome_to_string(telemetry.outcome), telemetry.duration, telemetry.bytes_read, telemetry.reads,
+           telemetry.read_size, telemetry.ndef_size, telemetry.exchanges, telemetry.retries);
+
+#ifdef USE_SENSOR
+  if (this->read_duration_sensor_ != nullptr)
+    this->read_duration_sensor_->publish_state(telemetry.duration);
+  if (this->bytes_read_sensor_ != nullptr)
+    this->bytes_read_sensor_->publish_state(telemetry.bytes_read);
+  if (this->ndef_size_sensor_ != nullptr)
+    this->ndef_size_sensor_->publish_state(telemetry.ndef_size);
+  if (this->over_read_ratio_sensor_ != nullptr) {
+    // without a message there is nothing the bytes read could be compared to
+    this->over_read_ratio_sensor_->publish_state(
+        telemetry.ndef_size == 0 ? NAN : float(telemetry.bytes_read) / float(telemetry.ndef_size));
   }
+  if (this->reads_sensor_ != nullptr)
+    this->reads_sensor_->publish_state(telemetry.reads);
+  if (this->read_size_sensor_ != nullptr)
+    this->read_size_sensor_->publish_state(telemetry.read_size);
+  if (this->exchanges_sensor_ != nullptr)
+    this->exchanges_sensor_->publish_state(telemetry.exchanges);
+  if (this->retries_sensor_ != nullptr)
+    this->retries_sensor_->publish_state(telemetry.retries);
+  if (this->read_success_rate_sensor_ != nullptr)
+    this->read_success_rate_sensor_->publish_state(this->get_read_success_rate());
+#endif
+#ifdef USE_TEXT_SENSOR
+  if (this->read_outcome_text_sensor_ != nullptr)
+    this->read_outcome_text_sensor_->publish_state(read_outcome_to_string(telemetry.outcome));
+#endif
+}
 
-  this->publish_state(true);
-  this->found_ = true;
-  return true;
+float PN532::get_read_success_rate() const {
+  if (this->read_history_count_ == 0)
+    return NAN;
+  const uint32_t mask = this->read_history_count_ < 32 ? (1UL << this->read_history_count_) - 1 : UINT32_MAX;
+  return __builtin_popcount(this->read_history_ & mask) * 100.0f / this->read_history_count_;
+}
+
+#ifdef USE_PN532_MEMORY_STATS
+void PN532::record_memory_stats_(const PN532Operation operation, const MemorySample &before) {
+  const auto after = sample_memory();
+  const uint32_t largest_free_block = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  auto &stats = this->memory_stats_[operation];
+  stats.operations++;
+  // a lower lifetime minimum than before was reached during the operation; otherwise only what it kept is known
+  const uint32_t lowest = after.min_free_heap < before.min_free_heap ? after.min_free_heap : after.free_heap;
+  if (before.free_heap > lowest)
+    stats.heap_peak = std::max(stats.heap_peak, before.free_heap - lowest);
+  stats.largest_free_block = std::min(stats.largest_free_block, largest_free_block);
+  if (after.stack_free < before.stack_free)
+    stats.stack_free = std::min(stats.stack_free, after.stack_free);
+  ESP_LOGV(TAG, "%s: %" PRIu32 " bytes of heap free before, %" PRIu32 " after, %" PRIu32 " bytes of stack left",
+           operation_to_string(operation), before.free_heap, after.free_heap, after.stack_free);
+
+  auto **sensors = this->memory_sensors_[operation];
+  if (sensors[MEMORY_HEAP_PEAK] != nullptr)
+    sensors[MEMORY_HEAP_PEAK]->publish_state(stats.heap_peak);
+  if (sensors[MEMORY_LARGEST_FREE_BLOCK] != nullptr)
+    sensors[MEMORY_LARGEST_FREE_BLOCK]->publish_state(stats.largest_free_block);
+  if (sensors[MEMORY_STACK_FREE] != nullptr && stats.stack_free != UINT32_MAX)
+    sensors[MEMORY_STACK_FREE]->publish_state(stats.stack_free);
+}
+
+void PN532::log_memory_stats_() {
+  for (uint8_t i = 0; i < OPERATION_COUNT; i++) {
+    const auto &stats = this->memory_stats_[i];
+    if (stats.operations == 0)
+      continue;
+    ESP_LOGD(TAG,
+             "%s memory over %" PRIu32 " operations: heap peak %" PRIu32 " bytes, largest free block %" PRIu32
+             " bytes",
+             operation_to_string(PN532Operation(i)), stats.operations, stats.heap_peak, stats.largest_free_block);
+    if (stats.stack_free != UINT32_MAX)
+      ESP_LOGD(TAG, "  Least stack left: %" PRIu32 " bytes", stats.stack_free);
+  }
+}
+#endif
+
+void PN532::report_tag_removed_() {
+  if (this->current_tag_ == nullptr)
+    return;
+
+  for (auto *listener : this->tag_listeners_)
+    listener->tag_off(*this->current_tag_);
+  for (auto *trigger : this->triggers_ontagremoved_)
+    trigger->process(this->current_tag_);
+  this->current_tag_ = nullptr;
+#ifdef USE_PN532_DEEP_SLEEP
+  this->retain_tag_({}, 0);
+#endif
+}
+
+#ifdef USE_PN532_DEEP_SLEEP
+void PN532::restore_retained_state_() {
+  const auto &state = *this->retained_state_;
+  if (state.uid_length == 0)
+    return;
+  std::vector<uint8_t> uid(state.uid, state.uid + state.uid_length);
+  ESP_LOGD(TAG, "Tag '%s' was in the field before deep sleep", nfc::format_uid(uid).c_str());
+  // poll the technology that found it first, as if it had just had a hit
+  std::stable_partition(this->polling_technologies_.begin(), this->polling_technologies_.end(),
+                        [&state](const PollingTechnology &technology) { return technology.brty == state.brty; });
+}
+
+bool PN532::is_retained_tag_(const std::vector<uint8_t> &uid, const uint32_t content_hash) {
+  if (this->retained_state_ == nullptr)
+    return false;
+  const auto &state = *this->retained_state_;
+  return state.uid_length == uid.size() && std::equal(uid.begin(), uid.end(), state.uid) &&
+         state.brty == this->current_tag_brty_ && state.content_hash == content_hash;
+}
+
+void PN532::retain_tag_(const std::vector<uint8_t> &uid, const uint32_t content_hash) {
+  if (this->retained_state_ == nullptr)
+    return;
+  auto &state = *this->retained_state_;
+  state.uid_length = std::min<size_t>(uid.size(), sizeof(state.uid));
+  std::copy(uid.begin(), uid.begin() + state.uid_length, state.uid);
+  state.brty = this->current_tag_brty_;
+  state.content_hash = content_hash;
+}
+
+void PN532::check_ready_for_sleep_() {
+  // nothing to publish once every technology has been polled without finding a tag
+  if (std::all_of(this->polling_technologies_.begin(), this->polling_technologies_.end(),
+                  [](const PollingTechnology &technology) { return technology.polls != 0; }))
+    this->ready_for_sleep_();
+}
+
+void PN532::ready_for_sleep_() {
+  if (this->ready_for_sleep_signalled_)
+    return;
+  this->ready_for_sleep_signalled_ = true;
+  ESP_LOGD(TAG, "Ready for deep sleep after %" PRIu32 " polling cycles", this->polling_cycle_);
+  this->on_ready_for_sleep_callback_.call();
 }
+#endif
 
 }  // namespace pn532
 }  // namespace esphome
@@ -2,10 +2,16 @@
 
 #include "esphome/core/component.h"
 #include "esphome/core/automation.h"
-#include "esphome/components/binary_sensor/binary_sensor.h"
+#include "esphome/core/defines.h"
 #include "esphome/components/nfc/nfc_tag.h"
 #include "esphome/components/nfc/nfc.h"
 #include "esphome/components/nfc/automation.h"
+#ifdef USE_SENSOR
+#include "esphome/components/sensor/sensor.h"
+#endif
+#ifdef USE_TEXT_SENSOR
+#include "esphome/components/text_sensor/text_sensor.h"
+#endif
 
 #include <cinttypes>
 #include <vector>
@@ -17,8 +23,78 @@ static const uint8_t PN532_COMMAND_VERSION_DATA = 0x02;
 static const uint8_t PN532_COMMAND_SAMCONFIGURATION = 0x14;
 static const uint8_t PN532_COMMAND_RFCONFIGURATION = 0x32;
 static const uint8_t PN532_COMMAND_INDATAEXCHANGE = 0x40;
+static const uint8_t PN532_COMMAND_INCOMMUNICATETHRU = 0x42;
 static const uint8_t PN532_COMMAND_INLISTPASSIVETARGET = 0x4A;
 static const uint8_t PN532_COMMAND_POWERDOWN = 0x16;
+static const uint8_t PN532_COMMAND_INPSL = 0x4E;
+static const uint8_t PN532_COMMAND_INRELEASE = 0x52;
+
+// BRit/BRti values for InPSL
+static const uint8_t PN532_BIT_RATE_106 = 0x00;
+static const uint8_t PN532_BIT_RATE_212 = 0x01;
+static const uint8_t PN532_BIT_RATE_424 = 0x02;
+// how many tags' negotiated bit rates are remembered
+static const uint8_t PN532_MAX_BIT_RATE_MEMORY = 8;
+
+// InDataExchange: MI (More Information) is set in the Tg byte while the host has more to send, and in the status
+// byte while the PN532 has more of the target's answer to return
+static const uint8_t PN532_INDATAEXCHANGE_MI = 0x40;
+static const uint8_t PN532_INDATAEXCHANGE_ERROR_MASK = 0x3F;
+// LEN covers TFI, command code and Tg, leaving this much of a normal information frame for target data
+static const uint8_t PN532_INDATAEXCHANGE_MAX_DATA = 252;
+// the answer to READ BINARY, SW1 SW2 included, has to fit that too: longer ones come in extended information
+// frames, which the transports don't parse
+static const uint8_t PN532_TYPE4_MAX_LE = PN532_INDATAEXCHANGE_MAX_DATA - 2;
+
+// InListPassiveTarget BrTy: the modulation/bit rate to poll with
+static const uint8_t PN532_BRTY_ISO14443A = 0x00;
+static const uint8_t PN532_BRTY_FELICA_212 = 0x01;
+static const uint8_t PN532_BRTY_FELICA_424 = 0x02;
+static const uint8_t PN532_BRTY_ISO14443B = 0x03;
+static const uint8_t PN532_BRTY_JEWEL = 0x04;
+// BrTy values there are polling technologies for, 0x00 up to this
+static const uint8_t PN532_BRTY_COUNT = 5;
+// InListPassiveTarget response offsets of a FeliCa target's IDm and a type B target's PUPI
+static const uint8_t PN532_FELICA_IDM_OFFSET = 4;
+static const uint8_t PN532_ISO14443B_PUPI_OFFSET = 3;
+static const uint8_t PN532_ISO14443B_PUPI_SIZE = 4;
+// and of a Jewel target's ID, after its SENS_RES; Jewel targets are Type 1 tags, which have no anticollision
+static const uint8_t PN532_JEWEL_ID_OFFSET = 4;
+static const uint8_t PN532_JEWEL_ID_SIZE = 4;
+// a technology with a hit within this many polling cycles is polled as often as the one seen most recently
+static const uint8_t PN532_POLL_RECENT_CYCLES = 16;
+// with the burst field policy, the field goes off after this many polls in a row found no tag
+static const uint8_t PN532_RF_BURST_EMPTY_POLLS = 8;
+// polling statistics are logged, and published to their sensors, every this many polling cycles
+static const uint16_t PN532_POLL_STATS_LOG_CYCLES = 256;
+// a CHECK response of this many blocks still fits one normal information frame
+static const uint8_t PN532_FELICA_MAX_BLOCKS =
+    (PN532_INDATAEXCHANGE_MAX_DATA - nfc::FELICA_CHECK_RSP_HEADER_SIZE) / nfc::FELICA_BLOCK_SIZE;
+// bounds used to recognise the nested TLVs and padded records some water meters write
+static const uint8_t PN532_ULTRALIGHT_MAX_NESTED_LENGTH = 100;
+static const uint8_t PN532_ULTRALIGHT_MAX_PADDED_PAYLOAD = 200;
+// how often a message a listener rejected (a failed CRC, say) is fetched from the tag again
+static const uint8_t PN532_NDEF_REREAD_ATTEMPTS = 2;
+// the read success rate is taken over this many of the most recent tag reads
+static const uint8_t PN532_READ_HISTORY_SIZE = 32;
+// how many PN532 instances get their state kept in RTC memory across deep sleep
+static const uint8_t PN532_MAX_RETAINED_STATES = 2;
+// the longest identifier kept: a triple size ISO14443A UID
+static const uint8_t PN532_RETAINED_UID_SIZE = 10;
+
+/// What happens to the RF field once a poll is done
+enum PN532RfFieldPolicy : uint8_t {
+  RF_FIELD_ALWAYS_OFF = 0,  // switched off after every poll
+  RF_FIELD_WHILE_PRESENT,   // kept on while a tag is in the field
+  RF_FIELD_BURST,           // kept on until PN532_RF_BURST_EMPTY_POLLS polls in a row found nothing
+};
+
+/// How reading a tag went
+enum PN532ReadOutcome : uint8_t {
+  READ_OUTCOME_COMPLETE = 0,  // everything the tag holds was read, whether that is an NDEF message or not
+  READ_OUTCOME_PARTIAL,       // a read failed, or the message was discarded, after some of the tag was read
+  READ_OUTCOME_FAILED,        // a read failed before anything was read
+};
 
 enum PN532ReadReady {
   WOULDBLOCK = 0,
@@ -26,9 +102,89 @@ enum PN532ReadReady {
   READY,
 };
 
-class PN532BinarySensor;
+enum PN532PollingMetric : uint8_t {
+  POLLING_POLLS = 0,
+  POLLING_HITS,
+  POLLING_METRIC_COUNT,
+};
+
+struct PollingTechnology {
+  uint8_t brty;
+  uint32_t polls;
+  uint32_t hits;
+  uint32_t last_polled;  // polling cycle
+  uint32_t last_hit;     // polling cycle, 0 if never
+};
 
-class PN532 : public PollingComponent {
+struct BitRateMemory {
+  std::vector<uint8_t> uid;
+  uint8_t bit_rate;
+};
+
+/// What reading the last tag took, from its detection until its NfcTag was ready
+struct ReadTelemetry {
+  uint32_t duration{0};    // ms
+  uint32_t bytes_read{0};  // tag data returned by read commands, re-reads included
+  uint32_t ndef_size{0};   // length of the decoded NDEF message, 0 without one
+  uint16_t reads{0};       // read commands: Classic blocks, Type 2 READs, READ BINARY, CHECK
+  uint16_t read_size{0};   // most tag data a single read command returned
+  uint16_t exchanges{0};   // commands sent to the PN532
+  uint8_t retries{0};      // NDEF re-reads and bit rate fallbacks
+  bool read_failed{false};
+  PN532ReadOutcome outcome{READ_OUTCOME_COMPLETE};
+};
+
+#ifdef USE_PN532_MEMORY_STATS
+/// NFC operations whose heap and stack use is tracked
+enum PN532Operation : uint8_t {
+  OPERATION_READ = 0,  // reading a newly found tag
+  OPERATION_WRITE,     // write_tag_()
+  OPERATION_TRIGGERS,  // tag listeners and on_tag triggers
+  OPERATION_COUNT,
+};
+
+enum PN532MemoryMetric : uint8_t {
+  MEMORY_HEAP_PEAK = 0,
+  MEMORY_LARGEST_FREE_BLOCK,
+  MEMORY_STACK_FREE,
+  MEMORY_METRIC_COUNT,
+};
+
+struct MemorySample {
+  uint32_t free_heap;
+  uint32_t min_free_heap;  // lowest free heap since boot
+  uint32_t stack_free;     // high-water mark of the calling task: the least stack it has had left
+};
+
+/// Heap and stack use of one kind of operation since boot. Memory is only sampled before and after an
+/// operation, so what it took in between is known only if it set a new low for the heap or the stack.
+struct MemoryStats {
+  uint32_t operations{0};
+  uint32_t heap_peak{0};                    // most heap a single operation took
+  uint32_t largest_free_block{UINT32_MAX};  // smallest largest free block left after one
+  uint32_t stack_free{UINT32_MAX};          // least stack left during one, UINT32_MAX until one sets a new low
+};
+#endif
+
+/// Password for NTAG21x/Ultralight EV1 tags whose UID starts with uid_prefix; the longest matching prefix wins
+struct UltralightPassword {
+  std::vector<uint8_t> uid_prefix;  // a whole UID for one tag, the manufacturer byte for a vendor, empty for any
+  uint32_t password;
+  uint16_t pack;  // the answer expected to PWD_AUTH, if check_pack
+  bool check_pack;
+};
+
+/// What a PN532 keeps in RTC memory so a wake from deep sleep can skip chip detection and recognise the tag it
+/// already reported
+struct PN532RetainedState {
+  bool configured;  // SAM configuration done since the last cold boot
+  uint8_t brty;     // technology the tag was found with
+  uint8_t uid_length;
+  uint8_t uid[PN532_RETAINED_UID_SIZE];
+  uint32_t content_hash;  // FNV-1 of the encoded NDEF message, 0 without one
+};
+
+class PN532 : public nfc::Nfcc, public PollingComponent {
  public:
   void setup() override;
 
@@ -40,66 +196,248 @@ class PN532 : public PollingComponent {
   void loop() override;
   void on_shutdown() override { powerdown(); }
 
-  void register_tag(PN532BinarySensor *tag) { this->binary_sensors_.push_back(tag); }
+  /// Adds a technology (InListPassiveTarget BrTy) to those polled; one is polled per update, see
+  /// select_polling_technology_()
+  void add_polling_technology(uint8_t brty) { this->polling_technologies_.push_back({brty, 0, 0, 0, 0}); }
+  void set_polling_idle_interval(uint8_t interval) { this->polling_idle_interval_ = interval; }
+  void set_rf_field_policy(PN532RfFieldPolicy policy) { this->rf_field_policy_ = policy; }
+#ifdef USE_PN532_MIFARE_ULTRALIGHT
+  void add_ultralight_password(const std::vector<uint8_t> &uid_prefix, uint32_t password) {
+    this->ultralight_passwords_.push_back({uid_prefix, password, 0, false});
+  }
+  void add_ultralight_password(const std::vector<uint8_t> &uid_prefix, uint32_t password, uint16_t pack) {
+    this->ultralight_passwords_.push_back({uid_prefix, password, pack, true});
+  }
+#endif
+  /// per-technology poll and hit counters
+  const std::vector<PollingTechnology> &get_polling_technologies() const { return this->polling_technologies_; }
+  const ReadTelemetry &get_read_telemetry() const { return this->read_telemetry_; }
+  /// percentage of the last PN532_READ_HISTORY_SIZE tag reads that were complete
+  float get_read_success_rate() const;
+#ifdef USE_SENSOR
+  void set_read_duration_sensor(sensor::Sensor *sensor) { this->read_duration_sensor_ = sensor; }
+  void set_bytes_read_sensor(sensor::Sensor *sensor) { this->bytes_read_sensor_ = sensor; }
+  void set_ndef_size_sensor(sensor::Sensor *sensor) { this->ndef_size_sensor_ = sensor; }
+  void set_over_read_ratio_sensor(sensor::Sensor *sensor) { this->over_read_ratio_sensor_ = sensor; }
+  void set_reads_sensor(sensor::Sensor *sensor) { this->reads_sensor_ = sensor; }
+  void set_read_size_sensor(sensor::Sensor *sensor) { this->read_size_sensor_ = sensor; }
+  void set_exchanges_sensor(sensor::Sensor *sensor) { this->exchanges_sensor_ = sensor; }
+  void set_retries_sensor(sensor::Sensor *sensor) { this->retries_sensor_ = sensor; }
+  void set_read_success_rate_sensor(sensor::Sensor *sensor) { this->read_success_rate_sensor_ = sensor; }
+  void set_polling_sensor(uint8_t brty, PN532PollingMetric metric, sensor::Sensor *sensor) {
+    this->polling_sensors_[brty][metric] = sensor;
+  }
+#endif
+#ifdef USE_PN532_MEMORY_STATS
+  const MemoryStats &get_memory_stats(PN532Operation operation) const { return this->memory_stats_[operation]; }
+  void set_memory_sensor(PN532Operation operation, PN532MemoryMetric metric, sensor::Sensor *sensor) {
+    this->memory_sensors_[operation][metric] = sensor;
+  }
+#endif
+#ifdef USE_TEXT_SENSOR
+  void set_read_outcome_text_sensor(text_sensor::TextSensor *sensor) { this->read_outcome_text_sensor_ = sensor; }
+#endif
   void register_ontag_trigger(nfc::NfcOnTagTrigger *trig) { this->triggers_ontag_.push_back(trig); }
   void register_ontagremoved_trigger(nfc::NfcOnTagTrigger *trig) { this->triggers_ontagremoved_.push_back(trig); }
 
+#ifdef USE_PN532_WRITE
   void add_on_finished_write_callback(std::function<void()> callback) {
     this->on_finished_write_callback_.add(std::move(callback));
   }
+#endif
 
   bool is_writing() { return this->next_task_ != READ; };
 
+#ifdef USE_PN532_DEEP_SLEEP
+  /// Called once per boot, after the first tag was read and published (or found unchanged), or once every
+  /// technology has been polled without a tag
+  void add_on_ready_for_sleep_callback(std::function<void()> callback) {
+    this->on_ready_for_sleep_callback_.add(std::move(callback));
+  }
+#endif
+
   void read_mode();
+#ifdef USE_PN532_WRITE
   void clean_mode();
   void format_mode();
   void write_mode(nfc::NdefMessage *message);
+#endif
   bool powerdown();
 
  protected:
   void turn_off_rf_();
+  /// reports the current tag gone if the polled technology was the one that found it, then ends the poll
+  void handle_empty_poll_();
+  /// switches the field off, or releases the target and keeps it on, as the RF field policy says
+  void finish_poll_(bool target_active);
+  bool configure_sam_();
+  /// picks the technology to poll in this cycle: the one that saw a tag most recently, and any others that had a
+  /// hit within PN532_POLL_RECENT_CYCLES, are polled every cycle; the rest every polling_idle_interval_ cycles
+  PollingTechnology &select_polling_technology_();
+  void log_polling_stats_();
+  /// counts a read command that returned `bytes` of tag data towards the read telemetry
+  void count_read_(uint16_t bytes);
+  /// completes the read telemetry of `tag`, `detected` being millis() when the poll found it, and publishes it
+  void finish_read_telemetry_(nfc::NfcTag &tag, uint32_t detected);
+#ifdef USE_PN532_MEMORY_STATS
+  /// adds an operation that started with memory as in `before` to the stats of its kind and publishes them
+  void record_memory_stats_(PN532Operation operation, const MemorySample &before);
+  void log_memory_stats_();
+#endif
+  /// dispatches tag_off/on_tag_removed for the tag last seen in the field, if any
+  void report_tag_removed_();
   bool write_command_(const std::vector<uint8_t> &data);
-  bool read_ack_();
+  bool is_ack_(const std::vector<uint8_t> &data);
   void send_ack_();
   void send_nack_();
 
   enum PN532ReadReady read_ready_(bool block);
+  /// forgets a readiness that a non-blocking read_ready_() saw, once the response has been read some other way
+  void clear_read_ready_();
   virtual bool is_read_ready() = 0;
   virtual bool write_data(const std::vector<uint8_t> &data) = 0;
-  virtual bool read_data(std::vector<uint8_t> &data, uint8_t len) = 0;
+  virtual bool read_data(std::vector<uint8_t> &data, uint16_t len) = 0;
+  /// writes a command frame and reads the ACK frame into `ack` (status byte first, like read_data); transports that
+  /// can keep the bus between the two override this
+  virtual bool write_data_read_ack(const std::vector<uint8_t> &data, std::vector<uint8_t> &ack);
   virtual bool read_response(uint8_t command, std::vector<uint8_t> &data) = 0;
 
-  std::unique_ptr<nfc::NfcTag> read_tag_(std::vector<uint8_t> &uid);
+  std::unique_ptr<nfc::NfcTag> read_tag_(std::vector<uint8_t> &uid, uint8_t sel_res);
+  /// Decodes the message at [start, start + length) of `memory`, fetching it again while listeners reject it
+  std::unique_ptr<nfc::NdefMessage> decode_ndef_message_(nfc::TagMemory &memory, uint32_t start, uint32_t length);
 
+#ifdef USE_PN532_WRITE
   bool format_tag_(std::vector<uint8_t> &uid);
   bool clean_tag_(std::vector<uint8_t> &uid);
   bool write_tag_(std::vector<uint8_t> &uid, nfc::NdefMessage *message);
+#endif
 
+#ifdef USE_PN532_MIFARE_CLASSIC
   std::unique_ptr<nfc::NfcTag> read_mifare_classic_tag_(std::vector<uint8_t> &uid);
   bool read_mifare_classic_block_(uint8_t block_num, std::vector<uint8_t> &data);
-  bool write_mifare_classic_block_(uint8_t block_num, std::vector<uint8_t> &data);
   bool auth_mifare_classic_block_(std::vector<uint8_t> &uid, uint8_t block_num, uint8_t key_num, const uint8_t *key);
+#ifdef USE_PN532_WRITE
+  bool write_mifare_classic_block_(uint8_t block_num, std::vector<uint8_t> &data);
   bool format_mifare_classic_mifare_(std::vector<uint8_t> &uid);
   bool format_mifare_classic_ndef_(std::vector<uint8_t> &uid);
   bool write_mifare_classic_tag_(std::vector<uint8_t> &uid, nfc::NdefMessage *message);
+#endif
+#endif
 
+#ifdef USE_PN532_MIFARE_ULTRALIGHT
   std::unique_ptr<nfc::NfcTag> read_mifare_ultralight_tag_(std::vector<uint8_t> &uid);
-  bool read_mifare_ultralight_bytes_(uint8_t start_page, uint16_t num_bytes, std::vector<uint8_t> &data);
-  bool is_mifare_ultralight_formatted_(const std::vector<uint8_t> &page_3_to_6);
+  std::unique_ptr<nfc::NfcTag> read_mifare_ultralight_message_(std::vector<uint8_t> &uid);
+  /// reads from a 16-bit page address (sector * 256 + page), switching sectors as needed
+  bool read_mifare_ultralight_bytes_(uint16_t start_page, uint16_t num_bytes, std::vector<uint8_t> &data);
+  /// sends SECTOR_SELECT unless the tag is known to be in `sector` already
+  bool select_mifare_ultralight_sector_(uint8_t sector);
+  /// leaves the tag in sector 0 once an operation is done, for whoever activates it next
+  void reset_mifare_ultralight_sector_();
+  const UltralightPassword *find_ultralight_password_(const std::vector<uint8_t> &uid);
+  /// sends PWD_AUTH with the password configured for `uid`, unless it was accepted since the tag was activated;
+  /// false only if there is a password and the tag refused it
+  bool authenticate_mifare_ultralight_(const std::vector<uint8_t> &uid);
+  /// reads AUTH0 and ACCESS.PROT from the configuration pages, once per activation
+  void read_mifare_ultralight_config_();
+  /// bytes at the start of the data area that can be read, or written, without the password just now
+  uint32_t get_mifare_ultralight_unprotected_size_(bool reading);
+  bool is_mifare_ultralight_formatted_(nfc::TagMemory &memory);
+  /// capacity byte of the capability container times 8, 0 if it cannot be read
   uint16_t read_mifare_ultralight_capacity_();
-  bool find_mifare_ultralight_ndef_(const std::vector<uint8_t> &page_3_to_6, uint16_t &message_length,
-                                    uint8_t &message_start_index);
-  bool write_mifare_ultralight_page_(uint8_t page_num, std::vector<uint8_t> &write_data);
+  bool find_mifare_ultralight_ndef_(nfc::TagMemory &memory, uint32_t &message_start, uint32_t &message_length);
+  bool find_mifare_ultralight_record_(nfc::TagMemory &memory, uint32_t message_start, uint32_t message_length,
+                                      uint32_t &record_start, uint32_t &record_length);
+#ifdef USE_PN532_WRITE
+  bool write_mifare_ultralight_page_(uint16_t page_num, std::vector<uint8_t> &write_data);
   bool write_mifare_ultralight_tag_(std::vector<uint8_t> &uid, nfc::NdefMessage *message);
-  bool clean_mifare_ultralight_();
+  bool write_mifare_ultralight_message_(nfc::NdefMessage *message);
+  bool clean_mifare_ultralight_(std::vector<uint8_t> &uid);
+#endif
+#endif
+
+#ifdef USE_PN532_FELICA
+  std::unique_ptr<nfc::NfcTag> read_felica_tag_(std::vector<uint8_t> &idm);
+  bool read_felica_blocks_(const std::vector<uint8_t> &idm, uint16_t start_block, uint8_t num_blocks,
+                           std::vector<uint8_t> &data);
+#endif
+
+#ifdef USE_PN532_TYPE1
+  std::unique_ptr<nfc::NfcTag> read_type1_tag_(std::vector<uint8_t> &uid);
+  /// READALL: HR0, HR1 and blocks 0x00-0x0E
+  bool read_type1_all_(std::vector<uint8_t> &data);
+  /// RSEG: appends the 128 bytes of `segment` to `data`
+  bool read_type1_segment_(uint8_t segment, std::vector<uint8_t> &data);
+#endif
+
+#ifdef USE_PN532_TYPE4
+  std::unique_ptr<nfc::NfcTag> read_type4_tag_(std::vector<uint8_t> &uid);
+  bool select_type4_(uint8_t p1, const uint8_t *id, uint8_t id_length);
+  bool read_type4_binary_(uint16_t offset, uint16_t length, uint8_t max_le, std::vector<uint8_t> &data);
+  /// sends an APDU, returning the response data only if the status word is 90 00
+  bool transceive_apdu_(const std::vector<uint8_t> &apdu, std::vector<uint8_t> &response);
+#endif
+  /// InDataExchange with MI chaining in both directions; response is the target's complete answer. Retried once at
+  /// 106 kbit/s if it fails at a higher bit rate.
+  bool in_data_exchange_(const std::vector<uint8_t> &data, std::vector<uint8_t> &response);
+  bool in_data_exchange_chained_(const std::vector<uint8_t> &data, std::vector<uint8_t> &response);
+
+#ifdef USE_PN532_TYPE4
+  /// picks the fastest bit rate both the ATS and the PN532 allow (or what worked last time for this UID) and
+  /// switches to it with InPSL
+  void negotiate_bit_rate_(const std::vector<uint8_t> &uid, const std::vector<uint8_t> &ats);
+#endif
+  bool set_bit_rate_(uint8_t bit_rate_it, uint8_t bit_rate_ti);
+  void remember_bit_rate_(const std::vector<uint8_t> &uid, uint8_t bit_rate);
+
+#ifdef USE_PN532_DEEP_SLEEP
+  /// puts the technology of the tag seen before deep sleep first in line for polling
+  void restore_retained_state_();
+  /// whether this is the tag, with the same content, that was reported before the last deep sleep
+  bool is_retained_tag_(const std::vector<uint8_t> &uid, uint32_t content_hash);
+  void retain_tag_(const std::vector<uint8_t> &uid, uint32_t content_hash);
+  /// signals readiness for sleep if every technology has been polled
+  void check_ready_for_sleep_();
+  void ready_for_sleep_();
+#endif
 
   bool updates_enabled_{true};
   bool requested_read_{false};
-  std::vector<PN532BinarySensor *> binary_sensors_;
   std::vector<nfc::NfcOnTagTrigger *> triggers_ontag_;
   std::vector<nfc::NfcOnTagTrigger *> triggers_ontagremoved_;
-  std::vector<uint8_t> current_uid_;
+  std::unique_ptr<nfc::NfcTag> current_tag_;
+  uint8_t current_tag_brty_{PN532_BRTY_ISO14443A};
+  std::vector<PollingTechnology> polling_technologies_;
+  uint32_t polling_cycle_{0};
+  ReadTelemetry read_telemetry_;
+  /// outcomes of the most recent tag reads, newest in bit 0; a set bit is a complete read
+  uint32_t read_history_{0};
+  uint8_t read_history_count_{0};
+  PN532RfFieldPolicy rf_field_policy_{RF_FIELD_ALWAYS_OFF};
+  /// the field was left on after the last poll
+  bool rf_field_kept_on_{false};
+  uint8_t empty_polls_{0};
+  uint8_t polling_idle_interval_{4};
+  uint8_t poll_brty_{PN532_BRTY_ISO14443A};
+  std::vector<uint8_t> bit_rate_uid_;
+  std::vector<BitRateMemory> bit_rate_memory_;
+  uint8_t bit_rate_{PN532_BIT_RATE_106};
+  /// sector the activated Type 2 tag was last switched to
+  uint8_t ultralight_sector_{0};
+  /// the activated Type 2 tag accepted PWD_AUTH
+  bool ultralight_authenticated_{false};
+  bool ultralight_config_read_{false};
+  /// first page that needs the password, past the end of sector 0 if none
+  uint16_t ultralight_auth0_{nfc::MIFARE_ULTRALIGHT_SECTOR_PAGES};
+  bool ultralight_read_protected_{false};
+  /// data area size from the capability container, read once per activation
+  uint16_t ultralight_capacity_{0};
+  bool ultralight_capacity_read_{false};
+#ifdef USE_PN532_MIFARE_ULTRALIGHT
+  std::vector<UltralightPassword> ultralight_passwords_;
+#endif
+#ifdef USE_PN532_WRITE
   nfc::NdefMessage *next_task_message_to_write_;
+#endif
   uint32_t rd_start_time_{0};
   enum PN532ReadReady rd_ready_ { WOULDBLOCK };
   enum NfcTask {
@@ -113,33 +451,52 @@ class PN532 : public PollingComponent {
     WAKEUP_FAILED,
     SAM_COMMAND_FAILED,
   } error_code_{NONE};
+#ifdef USE_PN532_WRITE
   CallbackManager<void()> on_finished_write_callback_;
+#endif
+#ifdef USE_SENSOR
+  sensor::Sensor *read_duration_sensor_{nullptr};
+  sensor::Sensor *bytes_read_sensor_{nullptr};
+  sensor::Sensor *ndef_size_sensor_{nullptr};
+  sensor::Sensor *over_read_ratio_sensor_{nullptr};
+  sensor::Sensor *reads_sensor_{nullptr};
+  sensor::Sensor *read_size_sensor_{nullptr};
+  sensor::Sensor *exchanges_sensor_{nullptr};
+  sensor::Sensor *retries_sensor_{nullptr};
+  sensor::Sensor *read_success_rate_sensor_{nullptr};
+  sensor::Sensor *polling_sensors_[PN532_BRTY_COUNT][POLLING_METRIC_COUNT]{};
+#endif
+#ifdef USE_TEXT_SENSOR
+  text_sensor::TextSensor *read_outcome_text_sensor_{nullptr};
+#endif
+#ifdef USE_PN532_MEMORY_STATS
+  MemoryStats memory_stats_[OPERATION_COUNT];
+  sensor::Sensor *memory_sensors_[OPERATION_COUNT][MEMORY_METRIC_COUNT]{};
+#endif
+#ifdef USE_PN532_DEEP_SLEEP
+  PN532RetainedState *retained_state_{nullptr};
+  bool ready_for_sleep_signalled_{false};
+  CallbackManager<void()> on_ready_for_sleep_callback_;
+#endif
 };
 
-class PN532BinarySensor : public binary_sensor::BinarySensor {
+#ifdef USE_PN532_WRITE
+class PN532OnFinishedWriteTrigger : public Trigger<> {
  public:
-  void set_uid(const std::vector<uint8_t> &uid) { uid_ = uid; }
-
-  bool process(std::vector<uint8_t> &data);
-
-  void on_scan_end() {
-    if (!this->found_) {
-      this->publish_state(false);
-    }
-    this->found_ = false;
+  explicit PN532OnFinishedWriteTrigger(PN532 *parent) {
+    parent->add_on_finished_write_callback([this]() { this->trigger(); });
   }
-
- protected:
-  std::vector<uint8_t> uid_;
-  bool found_{false};
 };
+#endif
 
-class PN532OnFinishedWriteTrigger : public Trigger<> {
+#ifdef USE_PN532_DEEP_SLEEP
+class PN532OnReadyForSleepTrigger : public Trigger<> {
  public:
-  explicit PN532OnFinishedWriteTrigger(PN532 *parent) {
-    parent->add_on_finished_write_callback([this]() { this->trigger(); });
+  explicit PN532OnReadyForSleepTrigger(PN532 *parent) {
+    parent->add_on_ready_for_sleep_callback([this]() { this->trigger(); });
   }
 };
+#endif
 
 template<typename... Ts> class PN532IsWritingCondition : public Condition<Ts...>, public Parented<PN532> {
  public:
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <memory>
+#include <cinttypes>
+
+#include "pn532.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace pn532 {
+
+#ifdef USE_PN532_FELICA
+
+static const char *const TAG = "pn532.felica";
+
+std::unique_ptr<nfc::NfcTag> PN532::read_felica_tag_(std::vector<uint8_t> &idm) {
+  // block 0 of the NDEF service is the attribute information block
+  std::vector<uint8_t> attr;
+  if (!this->read_felica_blocks_(idm, 0, 1, attr)) {
+    ESP_LOGW(TAG, "Failed to read attribute information block");
+    this->read_telemetry_.read_failed = true;
+    return make_unique<nfc::NfcTag>(idm, nfc::NFC_FORUM_TYPE_3);
+  }
+  ESP_LOGVV(TAG, "Attribute information: %s", nfc::format_bytes(attr).c_str());
+
+  uint16_t checksum = 0;
+  for (uint8_t i = 0; i < nfc::FELICA_ATTR_CHECKSUM_OFFSET; i++) {
+    checksum += attr[i];
+  }
+  if (checksum != ((attr[nfc::FELICA_ATTR_CHECKSUM_OFFSET] << 8) | attr[nfc::FELICA_ATTR_CHECKSUM_OFFSET + 1])) {
+    ESP_LOGW(TAG, "Invalid attribute information checksum");
+    return make_unique<nfc::NfcTag>(idm, nfc::NFC_FORUM_TYPE_3);
+  }
+
+  // Nbr is the most blocks the tag takes in one CHECK; use all of it, as far as a PN532 frame allows
+  const uint8_t max_blocks = std::min(attr[nfc::FELICA_ATTR_NBR_OFFSET], PN532_FELICA_MAX_BLOCKS);
+  const uint32_t message_length = (attr[nfc::FELICA_ATTR_LN_OFFSET] << 16) |
+                                  (attr[nfc::FELICA_ATTR_LN_OFFSET + 1] << 8) | attr[nfc::FELICA_ATTR_LN_OFFSET + 2];
+  ESP_LOGVV(TAG, "NDEF message length: %" PRIu32 ", Nbr: %u", message_length, attr[nfc::FELICA_ATTR_NBR_OFFSET]);
+  if (message_length == 0) {
+    return make_unique<nfc::NfcTag>(idm, nfc::NFC_FORUM_TYPE_3);
+  }
+  if (max_blocks == 0) {
+    ESP_LOGW(TAG, "Invalid Nbr");
+    return make_unique<nfc::NfcTag>(idm, nfc::NFC_FORUM_TYPE_3);
+  }
+
+  // the message starts right after the attribute information block; each CHECK brings in up to max_blocks of it,
+  // and only when the decoder gets to them
+  const uint32_t total_blocks = (message_length + nfc::FELICA_BLOCK_SIZE - 1) / nfc::FELICA_BLOCK_SIZE;
+  nfc::TagMemory memory(message_length, max_blocks * nfc::FELICA_BLOCK_SIZE,
+                        [this, &idm, max_blocks, total_blocks](uint32_t unit, std::vector<uint8_t> &data) {
+                          const uint32_t block = unit * max_blocks;
+                          const uint8_t count = std::min<uint32_t>(total_blocks - block, max_blocks);
+                          if (!this->read_felica_blocks_(idm, block + 1, count, data)) {
+                            ESP_LOGE(TAG, "Error reading blocks %" PRIu32 "-%" PRIu32, block + 1, block + count);
+                            this->read_telemetry_.read_failed = true;
+                            return false;
+                          }
+                          return true;
+                        });
+
+  auto message = this->decode_ndef_message_(memory, 0, message_length);
+  if (message == nullptr) {
+    return make_unique<nfc::NfcTag>(idm, nfc::NFC_FORUM_TYPE_3);
+  }
+  ESP_LOGVV(TAG, "Decoded %" PRIu32 " byte NDEF message with %" PRIu32 " CHECKs", message_length,
+            memory.get_fetch_count());
+  return make_unique<nfc::NfcTag>(idm, nfc::NFC_FORUM_TYPE_3, std::move(message));
+}
+
+bool PN532::read_felica_blocks_(const std::vector<uint8_t> &idm, const uint16_t start_block, const uint8_t num_blocks,
+                                std::vector<uint8_t> &data) {
+  std::vector<uint8_t> command = {0x00, nfc::FELICA_CMD_CHECK};
+  command.insert(command.end(), idm.begin(), idm.end());
+  command.insert(command.end(), {
+                                    0x01,  // one service
+                                    nfc::FELICA_NDEF_SERVICE_CODE_READ & 0xFF,
+                                    nfc::FELICA_NDEF_SERVICE_CODE_READ >> 8,
+                                    num_blocks,
+                                });
+  for (uint16_t block = start_block; block < start_block + num_blocks; block++) {
+    if (block <= 0xFF) {
+      // two byte block list element
+      command.insert(command.end(), {0x80, uint8_t(block)});
+    } else {
+      command.insert(command.end(), {0x00, uint8_t(block & 0xFF), uint8_t(block >> 8)});
+    }
+  }
+  command[0] = command.size();
+
+  std::vector<uint8_t> response;
+  if (!this->in_data_exchange_(command, response)) {
+    return false;
+  }
+
+  const size_t expected = nfc::FELICA_CHECK_RSP_HEADER_SIZE + num_blocks * nfc::FELICA_BLOCK_SIZE;
+  if (response.size() < nfc::FELICA_CHECK_RSP_HEADER_SIZE || response[1] != nfc::FELICA_RSP_CHECK ||
+      response[nfc::FELICA_CHECK_RSP_STATUS1_OFFSET] != 0x00 || response.size() < expected) {
+    ESP_LOGV(TAG, "CHECK failed: %s", nfc::format_bytes(response).c_str());
+    return false;
+  }
+
+  data.insert(data.end(), response.begin() + nfc::FELICA_CHECK_RSP_HEADER_SIZE, response.begin() + expected);
+  this->count_read_(num_blocks * nfc::FELICA_BLOCK_SIZE);
+  return true;
+}
+
+#endif  // USE_PN532_FELICA
+
+}  // namespace pn532
+}  // namespace esphome
@@ -1,4 +1,5 @@
 #include <memory>
+#include <cinttypes>
 
 #include "pn532.h"
 #include "esphome/core/log.h"
@@ -6,60 +7,79 @@
 namespace esphome {
 namespace pn532 {
 
+#ifdef USE_PN532_MIFARE_CLASSIC
+
 static const char *const TAG = "pn532.mifare_classic";
 
+// sectors 1-31 hold three data blocks each, the 16 block sectors 32-39 of a 4K tag fifteen
+static const uint32_t NDEF_LOW_SECTOR_BLOCKS = nfc::MIFARE_CLASSIC_BLOCKS_PER_SECT_LOW - 1;
+static const uint32_t NDEF_HIGH_SECTOR_BLOCKS = nfc::MIFARE_CLASSIC_BLOCKS_PER_SECT_HIGH - 1;
+static const uint32_t NDEF_LOW_BLOCKS = (nfc::MIFARE_CLASSIC_16BLOCK_SECT_START - 1) * NDEF_LOW_SECTOR_BLOCKS;
+static const uint32_t NDEF_AREA_SIZE = (NDEF_LOW_BLOCKS + 8 * NDEF_HIGH_SECTOR_BLOCKS) * nfc::MIFARE_CLASSIC_BLOCK_SIZE;
+
+/// Sector holding data block `index` of the NDEF area
+static uint8_t ndef_sector(const uint32_t index) {
+  if (index < NDEF_LOW_BLOCKS) {
+    return 1 + index / NDEF_LOW_SECTOR_BLOCKS;
+  }
+  return nfc::MIFARE_CLASSIC_16BLOCK_SECT_START + (index - NDEF_LOW_BLOCKS) / NDEF_HIGH_SECTOR_BLOCKS;
+}
+
+/// Block number of data block `index` of the NDEF area
+static uint8_t ndef_block(const uint32_t index) {
+  const uint8_t sector = ndef_sector(index);
+  if (index < NDEF_LOW_BLOCKS) {
+    return sector * nfc::MIFARE_CLASSIC_BLOCKS_PER_SECT_LOW + index % NDEF_LOW_SECTOR_BLOCKS;
+  }
+  return nfc::MIFARE_CLASSIC_16BLOCK_SECT_START * nfc::MIFARE_CLASSIC_BLOCKS_PER_SECT_LOW +
+         (sector - nfc::MIFARE_CLASSIC_16BLOCK_SECT_START) * nfc::MIFARE_CLASSIC_BLOCKS_PER_SECT_HIGH +
+         (index - NDEF_LOW_BLOCKS) % NDEF_HIGH_SECTOR_BLOCKS;
+}
+
 std::unique_ptr<nfc::NfcTag> PN532::read_mifare_classic_tag_(std::vector<uint8_t> &uid) {
-  uint8_t current_block = 4;
-  uint8_t message_start_index = 0;
-  uint32_t message_length = 0;
-
-  if (this->auth_mifare_classic_block_(uid, current_block, nfc::MIFARE_CMD_AUTH_A, nfc::NDEF_KEY)) {
-    std::vector<uint8_t> data;
-    if (this->read_mifare_classic_block_(current_block, data)) {
-      if (!nfc::decode_mifare_classic_tlv(data, message_length, message_start_index)) {
-        return make_unique<nfc::NfcTag>(uid, nfc::ERROR);
-      }
-    } else {
-      ESP_LOGE(TAG, "Failed to read block %d", current_block);
-      return make_unique<nfc::NfcTag>(uid, nfc::MIFARE_CLASSIC);
-    }
-  } else {
+  if (!this->auth_mifare_classic_block_(uid, ndef_block(0), nfc::MIFARE_CMD_AUTH_A, nfc::NDEF_KEY)) {
     ESP_LOGV(TAG, "Tag is not NDEF formatted");
     return make_unique<nfc::NfcTag>(uid, nfc::MIFARE_CLASSIC);
   }
 
-  uint32_t index = 0;
-  uint32_t buffer_size = nfc::get_mifare_classic_buffer_size(message_length);
-  std::vector<uint8_t> buffer;
-
-  while (index < buffer_size) {
-    if (nfc::mifare_classic_is_first_block(current_block)) {
-      if (!this->auth_mifare_classic_block_(uid, current_block, nfc::MIFARE_CMD_AUTH_A, nfc::NDEF_KEY)) {
-        ESP_LOGE(TAG, "Error, Block authentication failed for %d", current_block);
-      }
-    }
-    std::vector<uint8_t> block_data;
-    if (this->read_mifare_classic_block_(current_block, block_data)) {
-      buffer.insert(buffer.end(), block_data.begin(), block_data.end());
-    } else {
-      ESP_LOGE(TAG, "Error reading block %d", current_block);
-    }
-
-    index += nfc::MIFARE_CLASSIC_BLOCK_SIZE;
-    current_block++;
-
-    if (nfc::mifare_classic_is_trailer_block(current_block)) {
-      current_block++;
-    }
+  // blocks are only fetched, and their sector authenticated, once the decoder gets to them
+  uint8_t authenticated_sector = ndef_sector(0);
+  nfc::TagMemory memory(NDEF_AREA_SIZE, nfc::MIFARE_CLASSIC_BLOCK_SIZE,
+                        [this, &uid, &authenticated_sector](uint32_t index, std::vector<uint8_t> &data) {
+                          const uint8_t block = ndef_block(index);
+                          if (ndef_sector(index) != authenticated_sector) {
+                            if (!this->auth_mifare_classic_block_(uid, block, nfc::MIFARE_CMD_AUTH_A, nfc::NDEF_KEY)) {
+                              ESP_LOGE(TAG, "Error, Block authentication failed for %d", block);
+                              this->read_telemetry_.read_failed = true;
+                              return false;
+                            }
+                            authenticated_sector = ndef_sector(index);
+                          }
+                          if (!this->read_mifare_classic_block_(block, data)) {
+                            ESP_LOGE(TAG, "Error reading block %d", block);
+                            this->read_telemetry_.read_failed = true;
+                            return false;
+                          }
+                          return true;
+                        });
+
+  uint32_t message_start;
+  uint32_t message_length;
+  if (!nfc::find_ndef_tlv(memory, message_start, message_length)) {
+    ESP_LOGE(TAG, "Error, Can't decode message length.");
+    return make_unique<nfc::NfcTag>(uid, nfc::ERROR);
   }
-
-  if (buffer.begin() + message_start_index < buffer.end()) {
-    buffer.erase(buffer.begin(), buffer.begin() + message_start_index);
-  } else {
+  if (message_length == 0) {
     return make_unique<nfc::NfcTag>(uid, nfc::MIFARE_CLASSIC);
   }
 
-  return make_unique<nfc::NfcTag>(uid, nfc::MIFARE_CLASSIC, buffer);
+  auto message = this->decode_ndef_message_(memory, message_start, message_length);
+  if (message == nullptr) {
+    return make_unique<nfc::NfcTag>(uid, nfc::MIFARE_CLASSIC);
+  }
+  ESP_LOGVV(TAG, "Decoded %" PRIu32 " byte NDEF message from %" PRIu32 " blocks", message_length,
+            memory.get_fetch_count());
+  return make_unique<nfc::NfcTag>(uid, nfc::MIFARE_CLASSIC, std::move(message));
 }
 
 bool PN532::read_mifare_classic_block_(uint8_t block_num, std::vector<uint8_t> &data) {
@@ -76,6 +96,7 @@ bool PN532::read_mifare_classic_block_(uint8_t block_num, std::vector<uint8_t> &
     return false;
   }
   data.erase(data.begin());
+  this->count_read_(data.size());
 
   ESP_LOGVV(TAG, " Block %d: %s", block_num, nfc::format_bytes(data).c_str());
   return true;
@@ -105,6 +126,7 @@ bool PN532::auth_mifare_classic_block_(std::vector<uint8_t> &uid, uint8_t block_
   return true;
 }
 
+#ifdef USE_PN532_WRITE
 bool PN532::format_mifare_classic_mifare_(std::vector<uint8_t> &uid) {
   std::vector<uint8_t> blank_buffer(
       {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
@@ -257,6 +279,9 @@ bool PN532::write_mifare_classic_tag_(std::vector<uint8_t> &uid, nfc::NdefMessag
   }
   return true;
 }
+#endif  // USE_PN532_WRITE
+
+#endif  // USE_PN532_MIFARE_CLASSIC
 
 }  // namespace pn532
 }  // namespace esphome
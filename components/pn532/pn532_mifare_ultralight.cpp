@@ -1,5 +1,6 @@
 #include <memory>
 #include <algorithm>
+#include <cinttypes>
 
 #include "pn532.h"
 #include "esphome/core/log.h"
@@ -7,501 +8,118 @@
 namespace esphome {
 namespace pn532 {
 
+#ifdef USE_PN532_MIFARE_ULTRALIGHT
+
 static const char *const TAG = "pn532.mifare_ultralight";
 
+// pages of the data area in sector 0, from page 4 up to the lock and configuration pages
+static const uint32_t SECTOR0_DATA_PAGES =
+    nfc::MIFARE_ULTRALIGHT_SECTOR0_LAST_DATA_PAGE + 1 - nfc::MIFARE_ULTRALIGHT_DATA_START_PAGE;
+
+// 16-bit address (sector * 256 + page) of the index-th page of the data area; past sector 0's part it goes on
+// at the start of sector 1
+static uint16_t data_page(const uint32_t index) {
+  if (index < SECTOR0_DATA_PAGES)
+    return nfc::MIFARE_ULTRALIGHT_DATA_START_PAGE + index;
+  return nfc::MIFARE_ULTRALIGHT_SECTOR_PAGES + (index - SECTOR0_DATA_PAGES);
+}
+
 std::unique_ptr<nfc::NfcTag> PN532::read_mifare_ultralight_tag_(std::vector<uint8_t> &uid) {
-  std::vector<uint8_t> data;
-  // pages 3 to 6 contain various info we are interested in -- do one read to grab it all
-  if (!this->read_mifare_ultralight_bytes_(3, nfc::MIFARE_ULTRALIGHT_PAGE_SIZE * nfc::MIFARE_ULTRALIGHT_READ_SIZE,
-                                           data)) {
+  this->ultralight_sector_ = 0;
+  if (!this->authenticate_mifare_ultralight_(uid)) {
+    // after the NAK the tag ignores everything until it is activated again
+    this->read_telemetry_.read_failed = true;
     return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_2);
   }
+  auto tag = this->read_mifare_ultralight_message_(uid);
+  this->reset_mifare_ultralight_sector_();
+  return tag;
+}
 
-  if (!this->is_mifare_ultralight_formatted_(data)) {
+std::unique_ptr<nfc::NfcTag> PN532::read_mifare_ultralight_message_(std::vector<uint8_t> &uid) {
+  // the decoder is kept inside the data area the capability container declares and, without the password, from
+  // running into a protected page: past either, the NAK would leave the tag deaf to every read after it
+  const uint32_t capacity = this->read_mifare_ultralight_capacity_();
+  if (capacity == 0) {
     ESP_LOGW(TAG, "Not NDEF formatted");
     return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_2);
   }
-
-  uint16_t message_length;
-  uint8_t message_start_index;
-  if (!this->find_mifare_ultralight_ndef_(data, message_length, message_start_index)) {
-    ESP_LOGW(TAG, "Couldn't find NDEF message");
+  const uint32_t unprotected = this->get_mifare_ultralight_unprotected_size_(true);
+  if (unprotected == 0) {
+    ESP_LOGW(TAG, "Data area is read protected and no password is configured for this tag");
+    this->read_telemetry_.read_failed = true;
     return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_2);
   }
-  ESP_LOGVV(TAG, "NDEF message length: %u, start: %u", message_length, message_start_index);
-  ESP_LOGD(TAG, "Initial data size: %u", data.size());
-
-  if (message_length == 0) {
-    return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_2);
+  const uint32_t size = std::min(capacity, unprotected);
+  if (size < capacity) {
+    ESP_LOGD(TAG, "Reading the first %" PRIu32 " of %" PRIu32 " bytes, the rest needs a password", size, capacity);
   }
-  // we already read pages 3-6 earlier -- pick up where we left off so we're not re-reading pages
-  const uint8_t read_length = message_length + message_start_index > 12 ? message_length + message_start_index - 12 : 0;
-  ESP_LOGD(TAG, "Need to read additional %u bytes (message_length=%u, start_index=%u)", 
-           read_length, message_length, message_start_index);
-  
-  // For water meter tags, we often need to read much more data than the TLV indicates
-  // Let's try to read additional data in increments, starting with what we need
-  // Water meter tags can have data spread across many pages, so be more aggressive
-  uint16_t target_read_length = std::max((uint16_t)read_length, (uint16_t)300);  // Start with 300 bytes for complex tags
-  ESP_LOGD(TAG, "Target read length: %u bytes (original: %u)", target_read_length, read_length);
-  
-  if (target_read_length > 0) {
-    // Try to read the target length first
-    if (!this->read_mifare_ultralight_bytes_(nfc::MIFARE_ULTRALIGHT_DATA_START_PAGE + 3, target_read_length, data)) {
-      ESP_LOGW(TAG, "Failed to read %u bytes, trying chunked reading", target_read_length);
-      
-      // Reset data to initial 16 bytes and try chunked reading
-      data.resize(16);
-      
-      // Try reading in chunks, accumulating data
-      std::vector<uint16_t> chunk_sizes = {32, 16, 8};  // Start with smaller chunks that are more likely to work
-      bool success = false;
-      
-      for (uint16_t chunk_size : chunk_sizes) {
-        ESP_LOGD(TAG, "Trying chunked reading with %u byte chunks", chunk_size);
-        
-        uint16_t bytes_read = 0;
-        uint8_t current_page = nfc::MIFARE_ULTRALIGHT_DATA_START_PAGE + 3;
-        data.resize(16);  // Reset to initial pages 3-6
-        
-        while (bytes_read < target_read_length) {
-          uint16_t bytes_to_read = std::min(chunk_size, (uint16_t)(target_read_length - bytes_read));
-          std::vector<uint8_t> chunk_data;
-          
-          if (!this->read_mifare_ultralight_bytes_(current_page, bytes_to_read, chunk_data)) {
-            ESP_LOGW(TAG, "Failed to read chunk of %u bytes at page %u", bytes_to_read, current_page);
-            // If we've already read some data, we can continue with what we have
-            if (bytes_read > 0) {
-              ESP_LOGD(TAG, "Continuing with %u bytes already read", bytes_read);
-              success = true;
-            }
-            break;
-          }
-          
-          data.insert(data.end(), chunk_data.begin(), chunk_data.end());
-          bytes_read += chunk_data.size();
-          current_page += (chunk_data.size() + nfc::MIFARE_ULTRALIGHT_PAGE_SIZE - 1) / nfc::MIFARE_ULTRALIGHT_PAGE_SIZE;
-          
-          ESP_LOGD(TAG, "Read chunk: %u bytes, total read: %u/%u", chunk_data.size(), bytes_read, target_read_length);
-        }
-        
-        // Consider it successful if we've read at least what we originally needed or 100 bytes
-        if (bytes_read >= std::min(target_read_length, (uint16_t)100) || success) {
-          if (!success) {
-            success = true;
-            ESP_LOGD(TAG, "Successfully read %u bytes using %u byte chunks (partial)", bytes_read, chunk_size);
+
+  // each READ brings in four pages of the data area, and only when the decoder reaches them
+  const uint32_t size_pages = (size + nfc::MIFARE_ULTRALIGHT_PAGE_SIZE - 1) / nfc::MIFARE_ULTRALIGHT_PAGE_SIZE;
+  nfc::TagMemory memory(
+      size, nfc::MIFARE_ULTRALIGHT_READ_SIZE * nfc::MIFARE_ULTRALIGHT_PAGE_SIZE,
+      [this, size_pages](uint32_t unit, std::vector<uint8_t> &data) {
+        uint32_t index = unit * nfc::MIFARE_ULTRALIGHT_READ_SIZE;
+        const uint32_t end = std::min(index + nfc::MIFARE_ULTRALIGHT_READ_SIZE, size_pages);
+        while (index < end) {
+          // the unit where sector 0's part of the data area ends is read in two goes
+          const uint32_t pages = index < SECTOR0_DATA_PAGES ? std::min(end, SECTOR0_DATA_PAGES) - index : end - index;
+          if (!this->read_mifare_ultralight_bytes_(data_page(index), pages * nfc::MIFARE_ULTRALIGHT_PAGE_SIZE, data)) {
+            this->read_telemetry_.read_failed = true;
+            return false;
           }
-          break;
+          index += pages;
         }
-      }
-      
-      if (!success) {
-        ESP_LOGW(TAG, "Failed to read additional data from tag with all chunk sizes, using initial data");
-        // Don't return an error - use the initial 16 bytes we already have
-        success = true;
-      }
-    }
-    ESP_LOGD(TAG, "After additional read, data size: %u", data.size());
-  }
-  
-  // Check if we have enough data to trim
-  uint32_t trim_offset = message_start_index + nfc::MIFARE_ULTRALIGHT_PAGE_SIZE;
-  if (data.size() < trim_offset) {
-    ESP_LOGE(TAG, "Not enough data to trim: data size %u, trim offset %u", data.size(), trim_offset);
+        return true;
+      });
+
+  if (!this->is_mifare_ultralight_formatted_(memory)) {
+    ESP_LOGW(TAG, "Not NDEF formatted");
     return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_2);
   }
-  
-  // Check if we have enough data for the message
-  if (data.size() < trim_offset + message_length) {
-    ESP_LOGW(TAG, "Not enough data for full message: data size %u, need %u", data.size(), trim_offset + message_length);
-    ESP_LOGW(TAG, "Truncating message to available data");
-    // Adjust message length to what's actually available
-    if (data.size() > trim_offset) {
-      message_length = data.size() - trim_offset;
-      ESP_LOGD(TAG, "Adjusted message length to %u bytes", message_length);
-    } else {
-      ESP_LOGE(TAG, "No message data available after trim offset");
-      return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_2);
-    }
+
+  uint32_t message_start;
+  uint32_t message_length;
+  if (!this->find_mifare_ultralight_ndef_(memory, message_start, message_length)) {
+    ESP_LOGW(TAG, "Couldn't find NDEF message");
+    return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_2);
   }
-  
-  // we need to trim off page 3 as well as any bytes ahead of message_start_index
-  // message_start_index is relative to start of page 4, so we add the page 4 offset
-  ESP_LOGD(TAG, "Before trimming: data size=%u, trim_offset=%u", data.size(), trim_offset);
-  
-  // Show some context around where we're trimming
-  if (data.size() >= trim_offset + 8 && trim_offset >= 4) {
-    std::vector<uint8_t> context_data(data.begin() + trim_offset - 4, data.begin() + trim_offset + 8);
-    ESP_LOGD(TAG, "Data around trim point: %s", nfc::format_bytes(context_data).c_str());
-  }
-  
-  data.erase(data.begin(), data.begin() + trim_offset);
-  
-  // Also trim the data to the exact message length
-  if (data.size() > message_length) {
-    data.resize(message_length);
-  }
-  
-  // Show the first few bytes of the NDEF message for debugging
-  ESP_LOGD(TAG, "First 16 bytes of NDEF message: %s", 
-           [&data]() {
-             std::vector<uint8_t> temp(data.begin(), data.begin() + std::min((size_t)16, data.size()));
-             return nfc::format_bytes(temp);
-           }().c_str());
-  
-  // Show full data for debugging water meter tags
-  ESP_LOGD(TAG, "Full NDEF message data (%u bytes): %s", data.size(),
-           data.size() <= 32 ? [&data]() {
-             std::vector<uint8_t> temp = data;
-             return nfc::format_bytes(temp);
-           }().c_str() : "too long to display");
-  
-  // Check if there's another TLV inside the message data
-  // Look for pattern like "xx xx xx xx 03 yy" where 03 is another NDEF TLV
-  std::vector<uint8_t> combined_inner_data;
-  bool found_inner_tlv = false;
-  uint32_t expected_total_size = 0;
-  
-  // Also look for direct NDEF record patterns (starting with flags like 0x54, 0xD1, etc.)
-  // These indicate the start of an actual NDEF record
-  std::vector<size_t> ndef_record_starts;
-  
-  ESP_LOGD(TAG, "Searching for NDEF record patterns in %u bytes of data", data.size());
-  
-  for (size_t i = 0; i < data.size() - 3; i++) {
-    uint8_t potential_flags = data[i];
-    ESP_LOGVV(TAG, "Checking offset %u: 0x%02X", i, potential_flags);
-    
-    // Check for common NDEF record flag patterns
-    if ((potential_flags & 0x07) <= 0x06 && // TNF field should be 0-6
-        (potential_flags & 0x10) != 0 &&     // SR (Short Record) bit should be set for short records
-        i + 3 < data.size()) {               // Make sure we have enough data for header
-      
-      uint8_t type_length = data[i + 1];
-      uint8_t payload_length = data[i + 2];
-      
-      ESP_LOGD(TAG, "Potential NDEF record at offset %u: flags=0x%02X, type_len=%u, payload_len=%u", 
-               i, potential_flags, type_length, payload_length);
-      
-      // Validate that this looks like a reasonable NDEF record
-      if (type_length <= 8 && payload_length > 0 && payload_length < 200) {
-        ESP_LOGD(TAG, "Found valid NDEF record at offset %u: flags=0x%02X, type_len=%u, payload_len=%u", 
-                 i, potential_flags, type_length, payload_length);
-        ndef_record_starts.push_back(i);
-        
-        // Calculate expected total size for this record
-        uint32_t expected_size = 3 + type_length + payload_length;
-        if (expected_total_size == 0) {
-          expected_total_size = expected_size;
-          ESP_LOGD(TAG, "Setting expected total size to %u based on NDEF record", expected_size);
-        }
-      }
-    }
+  ESP_LOGVV(TAG, "NDEF message length: %" PRIu32 ", start: %" PRIu32, message_length, message_start);
+
+  if (message_length == 0) {
+    return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_2);
   }
-  
-  // If we found direct NDEF record patterns, use the first one
-  if (!ndef_record_starts.empty()) {
-    size_t record_start = ndef_record_starts[0];
-    ESP_LOGD(TAG, "Using direct NDEF record starting at offset %u", record_start);
-    
-    // Extract as much data as we can from the record start
-    size_t available_data = data.size() - record_start;
-    
-    // If we don't have enough data for the complete record, try to read more first
-    if (expected_total_size > 0 && available_data < expected_total_size) {
-      ESP_LOGD(TAG, "Need %u more bytes for complete NDEF record, attempting to read more", 
-               expected_total_size - available_data);
-      
-      // Calculate how much more data we need
-      uint32_t bytes_needed = expected_total_size - available_data;
-      uint32_t current_data_size = data.size();
-      
-      // Try to read more data to get the complete record
-      // We need to read from where our current data ends
-      uint8_t start_page = nfc::MIFARE_ULTRALIGHT_DATA_START_PAGE + 
-                          (current_data_size / nfc::MIFARE_ULTRALIGHT_PAGE_SIZE);
-      
-      // Read extra bytes to ensure we get the complete record
-      uint16_t additional_read = bytes_needed + 64; // Add more buffer for safety
-      
-      ESP_LOGD(TAG, "Attempting to read %u additional bytes starting from page %u", 
-               additional_read, start_page);
-      
-      std::vector<uint8_t> additional_data;
-      if (this->read_mifare_ultralight_bytes_(start_page, additional_read, additional_data)) {
-        ESP_LOGD(TAG, "Successfully read %u additional bytes", additional_data.size());
-        data.insert(data.end(), additional_data.begin(), additional_data.end());
-        
-        // Update available data after successful read
-        available_data = data.size() - record_start;
-        ESP_LOGD(TAG, "Total data now: %u bytes, available for record: %u bytes", 
-                 data.size(), available_data);
-        
-        // Show more of the data for debugging
-        std::vector<uint8_t> debug_context(data.begin() + record_start, 
-                                          data.begin() + std::min(record_start + 32, data.size()));
-        ESP_LOGD(TAG, "Data around record start (offset %u): %s", record_start,
-                 nfc::format_bytes(debug_context).c_str());
-      } else {
-        ESP_LOGW(TAG, "Failed to read additional data for complete NDEF record");
-        
-        // Try multiple smaller reads as a fallback
-        ESP_LOGD(TAG, "Attempting fallback chunked reads");
-        uint8_t current_page = start_page;
-        std::vector<uint16_t> chunk_sizes = {64, 32, 16};
-        
-        for (uint16_t chunk_size : chunk_sizes) {
-          std::vector<uint8_t> chunk_data;
-          if (this->read_mifare_ultralight_bytes_(current_page, chunk_size, chunk_data)) {
-            ESP_LOGD(TAG, "Successfully read %u bytes in fallback chunk", chunk_data.size());
-            data.insert(data.end(), chunk_data.begin(), chunk_data.end());
-            
-            // Update available data
-            available_data = data.size() - record_start;
-            ESP_LOGD(TAG, "Total data now: %u bytes, available for record: %u bytes", 
-                     data.size(), available_data);
-            
-            // Check if we have enough now
-            if (expected_total_size > 0 && available_data >= expected_total_size) {
-              ESP_LOGD(TAG, "Got enough data with fallback reads");
-              break;
-            }
-            
-            // Move to next page for next chunk
-            current_page += (chunk_size + nfc::MIFARE_ULTRALIGHT_PAGE_SIZE - 1) / nfc::MIFARE_ULTRALIGHT_PAGE_SIZE;
-          } else {
-            ESP_LOGW(TAG, "Fallback chunk read of %u bytes failed", chunk_size);
-          }
-        }
-      }
-    }
-    
-    // Now extract the record data
-    available_data = data.size() - record_start;
-    size_t data_to_extract = available_data; // Default to all available data
-    
-    // If we have an expected size, try to extract exactly that much
-    if (expected_total_size > 0) {
-      if (available_data >= expected_total_size) {
-        data_to_extract = expected_total_size;
-      } else {
-        // Use all available data but warn about incompleteness
-        ESP_LOGW(TAG, "Only %u bytes available for NDEF record, expected %u", 
-                 available_data, expected_total_size);
-      }
-    }
-    
-    // Make sure we don't go beyond the data bounds
-    data_to_extract = std::min(data_to_extract, available_data);
-    
-    combined_inner_data = std::vector<uint8_t>(data.begin() + record_start, 
-                                              data.begin() + record_start + data_to_extract);
-    found_inner_tlv = true;
-    
-    ESP_LOGD(TAG, "Extracted %u bytes of direct NDEF record data", combined_inner_data.size());
-    
-    // Log the extracted data for debugging
-    std::vector<uint8_t> debug_data(combined_inner_data.begin(), 
-                                   combined_inner_data.begin() + std::min((size_t)32, combined_inner_data.size()));
-    ESP_LOGD(TAG, "Direct NDEF record data (first 32 bytes): %s", 
-             nfc::format_bytes(debug_data).c_str());
-    
-    // Check if we have the complete record now
-    if (expected_total_size > 0 && combined_inner_data.size() < expected_total_size) {
-      ESP_LOGW(TAG, "Direct NDEF record is still incomplete: have %u bytes, need %u", 
-               combined_inner_data.size(), expected_total_size);
-      ESP_LOGW(TAG, "This may be due to tag limitations or corruption");
-    } else if (expected_total_size > 0) {
-      ESP_LOGD(TAG, "Successfully extracted complete NDEF record (%u bytes)", combined_inner_data.size());
-    }
-  } else {
-    // Fall back to TLV-based approach
-    ESP_LOGD(TAG, "No direct NDEF record found, using TLV-based approach");
-    
-    // First, find all potential TLVs in the data
-    struct TlvInfo {
-      size_t offset;
-      uint8_t length;
-      std::vector<uint8_t> data;
-    };
-    std::vector<TlvInfo> found_tlvs;
-    
-    for (size_t i = 0; i < data.size() - 1; i++) {
-      if (data[i] == 0x03 && i + 1 < data.size()) {
-        uint8_t inner_length = data[i + 1];
-        ESP_LOGD(TAG, "Found potential inner TLV at offset %u: 03 %02X (length %u)", i, inner_length, inner_length);
-        
-        // If this inner TLV has a reasonable length and would fit in our data
-        if (inner_length > 0 && inner_length < 255 && i + 2 + inner_length <= data.size()) {
-          ESP_LOGD(TAG, "Inner TLV seems valid, extracting from offset %u with length %u", i + 2, inner_length);
-          
-          // Extract the inner message
-          std::vector<uint8_t> inner_data(data.begin() + i + 2, data.begin() + i + 2 + inner_length);
-          
-          ESP_LOGD(TAG, "Inner NDEF message (%u bytes): %s", inner_data.size(), 
-                   inner_data.size() <= 64 ? [&inner_data]() {
-                     std::vector<uint8_t> temp = inner_data;
-                     return nfc::format_bytes(temp);
-                   }().c_str() : "too long to display");
-          
-          // Store this TLV info
-          found_tlvs.push_back({i, inner_length, inner_data});
-          
-          // Analyze the NDEF record structure (only for the first TLV that looks like an NDEF record)
-          if (!found_inner_tlv && inner_data.size() >= 4) {
-            uint8_t flags = inner_data[0];
-            uint8_t type_length = inner_data[1];
-            
-            // Check if this looks like a valid NDEF record
-            if ((flags & 0x07) <= 0x06 && type_length <= 8) {
-              ESP_LOGD(TAG, "NDEF record analysis: flags=0x%02X, type_length=%u", flags, type_length);
-              ESP_LOGD(TAG, "  MB=%u, ME=%u, CF=%u, SR=%u, IL=%u, TNF=%u", 
-                       (flags >> 7) & 1, (flags >> 6) & 1, (flags >> 5) & 1, 
-                       (flags >> 4) & 1, (flags >> 3) & 1, flags & 7);
-              
-              // Check if this is a short record (SR=1)
-              bool is_short_record = (flags & 0x10) != 0;
-              if (is_short_record) {
-                ESP_LOGD(TAG, "  Short record format detected");
-                if (inner_data.size() >= 3) {
-                  uint8_t payload_length = inner_data[2];
-                  ESP_LOGD(TAG, "  Payload length: %u", payload_length);
-                  
-                  // The complete record should be: flags + type_length + payload_length + type + payload
-                  expected_total_size = 3 + type_length + payload_length;
-                  ESP_LOGD(TAG, "  Expected total record size: %u, actual: %u", expected_total_size, inner_data.size());
-                  
-                  // If the record is incomplete, we need to read more data
-                  if (expected_total_size > inner_data.size()) {
-                    ESP_LOGW(TAG, "  NDEF record is incomplete! Need %u more bytes", expected_total_size - inner_data.size());
-                  }
-                }
-              }
-            }
-          }
-          
-          // Skip ahead to avoid re-processing this TLV
-          i += inner_length + 1;
-        }
-      }
-    }
-    
-    // Now combine the TLVs to try to get a complete NDEF record
-    if (!found_tlvs.empty()) {
-      ESP_LOGD(TAG, "Found %u inner TLVs, attempting to combine", found_tlvs.size());
-      
-      // Start with the first TLV
-      combined_inner_data = found_tlvs[0].data;
-      found_inner_tlv = true;
-      
-      // If we have an incomplete record and multiple TLVs, try to combine them
-      if (expected_total_size > combined_inner_data.size() && found_tlvs.size() > 1) {
-        ESP_LOGD(TAG, "Attempting to combine TLVs to reach expected size %u", expected_total_size);
-        
-        for (size_t tlv_idx = 1; tlv_idx < found_tlvs.size(); tlv_idx++) {
-          const auto& tlv = found_tlvs[tlv_idx];
-          ESP_LOGD(TAG, "Appending TLV %u data (%u bytes)", tlv_idx, tlv.data.size());
-          combined_inner_data.insert(combined_inner_data.end(), tlv.data.begin(), tlv.data.end());
-          
-          // Check if we've reached the expected size
-          if (combined_inner_data.size() >= expected_total_size) {
-            ESP_LOGD(TAG, "Reached expected size %u with %u TLVs", expected_total_size, tlv_idx + 1);
-            break;
-          }
-        }
-      }
-    }
+
+  uint32_t record_start = message_start;
+  uint32_t record_length = message_length;
+  if (this->find_mifare_ultralight_record_(memory, message_start, message_length, record_start, record_length)) {
+    ESP_LOGD(TAG, "NDEF record found %" PRIu32 " bytes into the message", record_start - message_start);
   }
-  
-  if (found_inner_tlv) {
-    ESP_LOGD(TAG, "Using combined inner TLV data (%u bytes)", combined_inner_data.size());
-    
-    // For water meter tags, we often have all the data we need in the first few pages
-    // If we detected an incomplete NDEF record, try to read more data if possible
-    if (expected_total_size > 0 && combined_inner_data.size() < expected_total_size) {
-      uint32_t bytes_needed = expected_total_size - combined_inner_data.size();
-      ESP_LOGW(TAG, "NDEF record incomplete: have %u bytes, need %u (missing %u bytes)", 
-               combined_inner_data.size(), expected_total_size, bytes_needed);
-      
-      // Try to read more data if we haven't read enough yet
-      if (data.size() < 200) {
-        ESP_LOGD(TAG, "Attempting to read more data to complete NDEF record");
-        
-        // Try to read additional pages to get the complete record
-        uint16_t additional_read = bytes_needed + 50;  // Read extra to be safe
-        std::vector<uint8_t> expanded_data = data;
-        
-        // Calculate starting page based on how much data we already have
-        uint8_t start_page = nfc::MIFARE_ULTRALIGHT_DATA_START_PAGE + (data.size() / nfc::MIFARE_ULTRALIGHT_PAGE_SIZE);
-        
-        if (this->read_mifare_ultralight_bytes_(start_page, additional_read, expanded_data)) {
-          ESP_LOGD(TAG, "Successfully read %u additional bytes, total data now: %u", 
-                   expanded_data.size() - data.size(), expanded_data.size());
-          
-          // Look for the complete NDEF record in the expanded data
-          bool found_complete_record = false;
-          
-          // Search for the same NDEF record pattern in the expanded data
-          for (size_t i = 0; i < expanded_data.size() - 3; i++) {
-            uint8_t potential_flags = expanded_data[i];
-            if ((potential_flags & 0x07) <= 0x06 && (potential_flags & 0x10) != 0 && i + 3 < expanded_data.size()) {
-              uint8_t type_length = expanded_data[i + 1];
-              uint8_t payload_length = expanded_data[i + 2];
-              
-              if (type_length <= 8 && payload_length > 0 && payload_length < 200) {
-                uint32_t complete_size = 3 + type_length + payload_length;
-                if (complete_size == expected_total_size && i + complete_size <= expanded_data.size()) {
-                  ESP_LOGD(TAG, "Found complete NDEF record at offset %u with %u bytes in expanded data", i, complete_size);
-                  combined_inner_data = std::vector<uint8_t>(expanded_data.begin() + i, expanded_data.begin() + i + complete_size);
-                  found_complete_record = true;
-                  break;
-                }
-              }
-            }
-          }
-          
-          if (!found_complete_record) {
-            ESP_LOGW(TAG, "Still couldn't find complete NDEF record in expanded data");
-          }
-        } else {
-          ESP_LOGW(TAG, "Failed to read additional data from tag");
-        }
-      } else {
-        ESP_LOGW(TAG, "Already read sufficient data, working with partial NDEF record");
-      }
-      
-      if (combined_inner_data.size() < expected_total_size) {
-        ESP_LOGW(TAG, "Working with partial NDEF record - this may be sufficient for basic decoding");
-      }
-    }
-    
-    // Don't trim to expected size if we have partial data - use what we have
-    if (expected_total_size > 0 && combined_inner_data.size() >= expected_total_size) {
-      ESP_LOGD(TAG, "Trimming combined data to expected size: %u", expected_total_size);
-      combined_inner_data.resize(expected_total_size);
-    }
-    data = combined_inner_data;
+  auto message = this->decode_ndef_message_(memory, record_start, record_length);
+  if (message == nullptr) {
+    return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_2);
   }
-
-  ESP_LOGD(TAG, "Final NDEF message data (%u bytes): %s", data.size(), 
-           data.size() <= 100 ? [&data]() {  // Show more data for debugging
-             std::vector<uint8_t> temp = data; 
-             return nfc::format_bytes(temp); 
-           }().c_str() : "too long to display");
-
-  return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_2, data);
+  ESP_LOGVV(TAG, "Decoded NDEF message with %" PRIu32 " reads", memory.get_fetch_count());
+  return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_2, std::move(message));
 }
 
-bool PN532::read_mifare_ultralight_bytes_(uint8_t start_page, uint16_t num_bytes, std::vector<uint8_t> &data) {
-  const uint8_t read_increment = nfc::MIFARE_ULTRALIGHT_READ_SIZE * nfc::MIFARE_ULTRALIGHT_PAGE_SIZE;
+bool PN532::read_mifare_ultralight_bytes_(const uint16_t start_page, const uint16_t num_bytes,
+                                          std::vector<uint8_t> &data) {
   std::vector<uint8_t> response;
+  uint16_t page = start_page;
+  uint16_t remaining = num_bytes;
 
-  for (uint8_t i = 0; i * read_increment < num_bytes; i++) {
+  while (remaining > 0) {
+    if (!this->select_mifare_ultralight_sector_(page / nfc::MIFARE_ULTRALIGHT_SECTOR_PAGES)) {
+      return false;
+    }
+    const uint8_t page_in_sector = page % nfc::MIFARE_ULTRALIGHT_SECTOR_PAGES;
     if (!this->write_command_({
             PN532_COMMAND_INDATAEXCHANGE,
             0x01,  // One card
             nfc::MIFARE_CMD_READ,
-            uint8_t(i * nfc::MIFARE_ULTRALIGHT_READ_SIZE + start_page),
+            page_in_sector,
         })) {
       return false;
     }
@@ -509,12 +127,17 @@ bool PN532::read_mifare_ultralight_bytes_(uint8_t start_page, uint16_t num_bytes
     if (!this->read_response(PN532_COMMAND_INDATAEXCHANGE, response) || response[0] != 0x00) {
       return false;
     }
-    uint16_t bytes_offset = (i + 1) * read_increment;
-    auto pages_in_end_itr = bytes_offset <= num_bytes ? response.end() : response.end() - (bytes_offset - num_bytes);
-
-    if ((pages_in_end_itr > response.begin()) && (pages_in_end_itr <= response.end())) {
-      data.insert(data.end(), response.begin() + 1, pages_in_end_itr);
+    // READ wraps around to the start of the sector after its last page; only what comes before that is kept
+    const uint16_t pages = std::min<uint16_t>(nfc::MIFARE_ULTRALIGHT_READ_SIZE,
+                                              nfc::MIFARE_ULTRALIGHT_SECTOR_PAGES - page_in_sector);
+    const uint16_t count = std::min<uint16_t>(remaining, pages * nfc::MIFARE_ULTRALIGHT_PAGE_SIZE);
+    if (response.size() < 1U + count) {
+      return false;
     }
+    data.insert(data.end(), response.begin() + 1, response.begin() + 1 + count);
+    this->count_read_(count);
+    remaining -= count;
+    page += pages;
   }
 
   ESP_LOGVV(TAG, "Data read: %s", nfc::format_bytes(data).c_str());
@@ -522,134 +145,210 @@ bool PN532::read_mifare_ultralight_bytes_(uint8_t start_page, uint16_t num_bytes
   return true;
 }
 
-bool PN532::is_mifare_ultralight_formatted_(const std::vector<uint8_t> &page_3_to_6) {
-  const uint8_t p4_offset = nfc::MIFARE_ULTRALIGHT_PAGE_SIZE;  // page 4 will begin 4 bytes into the vector
+bool PN532::select_mifare_ultralight_sector_(const uint8_t sector) {
+  if (sector == this->ultralight_sector_) {
+    return true;
+  }
+  ESP_LOGV(TAG, "Selecting sector %u", sector);
+
+  // the first packet is answered with an ACK
+  std::vector<uint8_t> response;
+  if (!this->write_command_({PN532_COMMAND_INCOMMUNICATETHRU, nfc::MIFARE_CMD_SECTOR_SELECT, 0xFF}) ||
+      !this->read_response(PN532_COMMAND_INCOMMUNICATETHRU, response) || response[0] != 0x00 ||
+      (response.size() > 1 && response[1] != nfc::MIFARE_CMD_ACK)) {
+    ESP_LOGW(TAG, "SECTOR_SELECT not acknowledged");
+    return false;
+  }
+  // the second is acknowledged passively: any answer is a NAK, the PN532 timing out (status 0x01) means done
+  if (!this->write_command_({PN532_COMMAND_INCOMMUNICATETHRU, sector, 0x00, 0x00, 0x00}) ||
+      !this->read_response(PN532_COMMAND_INCOMMUNICATETHRU, response)) {
+    return false;
+  }
+  const uint8_t status = response[0] & PN532_INDATAEXCHANGE_ERROR_MASK;
+  if (status != 0x01 && !(status == 0x00 && response.size() == 1)) {
+    ESP_LOGW(TAG, "Tag refused sector %u", sector);
+    return false;
+  }
+  this->ultralight_sector_ = sector;
+  return true;
+}
+
+void PN532::reset_mifare_ultralight_sector_() {
+  if (this->ultralight_sector_ != 0 && !this->select_mifare_ultralight_sector_(0)) {
+    ESP_LOGW(TAG, "Tag left in sector %u", this->ultralight_sector_);
+  }
+}
+
+const UltralightPassword *PN532::find_ultralight_password_(const std::vector<uint8_t> &uid) {
+  const UltralightPassword *found = nullptr;
+  for (const auto &password : this->ultralight_passwords_) {
+    const auto &prefix = password.uid_prefix;
+    if (prefix.size() <= uid.size() && std::equal(prefix.begin(), prefix.end(), uid.begin()) &&
+        (found == nullptr || prefix.size() > found->uid_prefix.size())) {
+      found = &password;
+    }
+  }
+  return found;
+}
+
+bool PN532::authenticate_mifare_ultralight_(const std::vector<uint8_t> &uid) {
+  if (this->ultralight_authenticated_) {
+    return true;
+  }
+  const auto *password = this->find_ultralight_password_(uid);
+  if (password == nullptr) {
+    return true;
+  }
+
+  std::vector<uint8_t> response;
+  if (!this->write_command_({PN532_COMMAND_INCOMMUNICATETHRU, nfc::MIFARE_CMD_PWD_AUTH,
+                             uint8_t(password->password >> 24), uint8_t(password->password >> 16),
+                             uint8_t(password->password >> 8), uint8_t(password->password)}) ||
+      !this->read_response(PN532_COMMAND_INCOMMUNICATETHRU, response) || response[0] != 0x00 ||
+      response.size() < 1U + nfc::MIFARE_ULTRALIGHT_PACK_SIZE) {
+    ESP_LOGW(TAG, "Tag refused the password");
+    return false;
+  }
+  const uint16_t pack = (response[1] << 8) | response[2];
+  if (password->check_pack && pack != password->pack) {
+    // the tag knows the password but is not the one it was meant for
+    ESP_LOGW(TAG, "Unexpected PACK %04X", pack);
+    return false;
+  }
+  ESP_LOGV(TAG, "Password accepted, PACK %04X", pack);
+  this->ultralight_authenticated_ = true;
+  return true;
+}
+
+void PN532::read_mifare_ultralight_config_() {
+  if (this->ultralight_config_read_) {
+    return;
+  }
+  this->ultralight_config_read_ = true;
+  // nothing is protected on tags without configuration pages
+  this->ultralight_auth0_ = nfc::MIFARE_ULTRALIGHT_SECTOR_PAGES;
+  this->ultralight_read_protected_ = false;
+  const uint8_t config_page = nfc::get_mifare_ultralight_config_page(this->read_mifare_ultralight_capacity_());
+  if (config_page == 0) {
+    return;
+  }
+
+  std::vector<uint8_t> cfg;
+  if (!this->read_mifare_ultralight_bytes_(config_page, nfc::MIFARE_ULTRALIGHT_CFG_SIZE, cfg)) {
+    // the configuration pages lie past AUTH0 themselves and reads are protected: AUTH0 could be any page up to
+    // them, so none is taken to be readable
+    ESP_LOGV(TAG, "Configuration pages are read protected");
+    this->ultralight_auth0_ = 0;
+    this->ultralight_read_protected_ = true;
+    return;
+  }
+  // RFU bytes are zero on NTAG21x; anything else is an older tag of the same capacity, an NTAG203 say
+  if (cfg[1] != 0x00 || cfg[5] != 0x00 || cfg[6] != 0x00 || cfg[7] != 0x00) {
+    return;
+  }
+  this->ultralight_auth0_ = cfg[nfc::MIFARE_ULTRALIGHT_CFG_AUTH0_OFFSET];
+  this->ultralight_read_protected_ = cfg[nfc::MIFARE_ULTRALIGHT_CFG_ACCESS_OFFSET] & nfc::MIFARE_ULTRALIGHT_ACCESS_PROT;
+  ESP_LOGV(TAG, "AUTH0 0x%02X, %s protected", this->ultralight_auth0_,
+           this->ultralight_read_protected_ ? "reads and writes" : "writes");
+}
+
+uint32_t PN532::get_mifare_ultralight_unprotected_size_(const bool reading) {
+  if (this->ultralight_authenticated_) {
+    return nfc::MIFARE_ULTRALIGHT_MAX_DATA_SIZE;
+  }
+  this->read_mifare_ultralight_config_();
+  if ((reading && !this->ultralight_read_protected_) ||
+      this->ultralight_auth0_ > nfc::MIFARE_ULTRALIGHT_SECTOR0_LAST_DATA_PAGE) {
+    return nfc::MIFARE_ULTRALIGHT_MAX_DATA_SIZE;
+  }
+  if (this->ultralight_auth0_ <= nfc::MIFARE_ULTRALIGHT_DATA_START_PAGE) {
+    return 0;
+  }
+  return (this->ultralight_auth0_ - nfc::MIFARE_ULTRALIGHT_DATA_START_PAGE) * nfc::MIFARE_ULTRALIGHT_PAGE_SIZE;
+}
 
-  return (page_3_to_6.size() > p4_offset + 3) &&
-         ((page_3_to_6[p4_offset + 0] != 0xFF) || (page_3_to_6[p4_offset + 1] != 0xFF) ||
-          (page_3_to_6[p4_offset + 2] != 0xFF) || (page_3_to_6[p4_offset + 3] != 0xFF));
+bool PN532::is_mifare_ultralight_formatted_(nfc::TagMemory &memory) {
+  uint8_t page_4[nfc::MIFARE_ULTRALIGHT_PAGE_SIZE];
+  return memory.read(0, page_4, sizeof(page_4)) &&
+         ((page_4[0] != 0xFF) || (page_4[1] != 0xFF) || (page_4[2] != 0xFF) || (page_4[3] != 0xFF));
 }
 
 uint16_t PN532::read_mifare_ultralight_capacity_() {
+  if (this->ultralight_capacity_read_) {
+    return this->ultralight_capacity_;
+  }
   std::vector<uint8_t> data;
   if (this->read_mifare_ultralight_bytes_(3, nfc::MIFARE_ULTRALIGHT_PAGE_SIZE, data)) {
     if (data.size() >= 3) {
       ESP_LOGV(TAG, "Tag capacity is %u bytes", data[2] * 8U);
-      return data[2] * 8U;
+      this->ultralight_capacity_ = data[2] * 8U;
+      this->ultralight_capacity_read_ = true;
+      return this->ultralight_capacity_;
     }
   }
   return 0;
 }
 
-bool PN532::find_mifare_ultralight_ndef_(const std::vector<uint8_t> &page_3_to_6, uint16_t &message_length,
-                                         uint8_t &message_start_index) {
-  const uint8_t p4_offset = nfc::MIFARE_ULTRALIGHT_PAGE_SIZE;  // page 4 will begin 4 bytes into the vector
-  ESP_LOGD(TAG, "MALOG: find_mifare_ultralight_ndef_");
-  std::vector<uint8_t> page_data_copy = page_3_to_6;  // Create a copy for logging
-  ESP_LOGD(TAG, "Full page data (pages 3-6): %s", nfc::format_bytes(page_data_copy).c_str());
-  ESP_LOGD(TAG, "Page 4 data: %02X %02X %02X %02X", 
-           page_3_to_6[p4_offset + 0], page_3_to_6[p4_offset + 1], 
-           page_3_to_6[p4_offset + 2], page_3_to_6[p4_offset + 3]);
-  
-  // Log page 5 and 6 data as well for better debugging
-  if (page_3_to_6.size() >= p4_offset + 8) {
-    ESP_LOGD(TAG, "Page 5 data: %02X %02X %02X %02X", 
-             page_3_to_6[p4_offset + 4], page_3_to_6[p4_offset + 5], 
-             page_3_to_6[p4_offset + 6], page_3_to_6[p4_offset + 7]);
-  }
-  if (page_3_to_6.size() >= p4_offset + 12) {
-    ESP_LOGD(TAG, "Page 6 data: %02X %02X %02X %02X", 
-             page_3_to_6[p4_offset + 8], page_3_to_6[p4_offset + 9], 
-             page_3_to_6[p4_offset + 10], page_3_to_6[p4_offset + 11]);
-  }
-
-  if (!(page_3_to_6.size() > p4_offset + 5)) {
+bool PN532::find_mifare_ultralight_ndef_(nfc::TagMemory &memory, uint32_t &message_start,
+                                         uint32_t &message_length) {
+  if (!nfc::find_ndef_tlv(memory, message_start, message_length)) {
     return false;
   }
-
-  if (page_3_to_6[p4_offset + 0] == 0x03) {
-    
-	if (page_3_to_6[p4_offset + 1] == 0xFF) {
-      // The byte 0xFF could mean either:
-      // 1. Regular length = 255 bytes (2-byte TLV: Type=0x03, Length=0xFF)
-      // 2. Extended length indicator (4-byte TLV: Type=0x03, Ext=0xFF, Length=HH LL)
-      
-      // Check if we have enough data for extended length format
-      if (page_3_to_6.size() < p4_offset + 4) {
-        ESP_LOGE(TAG, "Not enough data for extended length format");
-        return false;
-      }
-      
-      uint8_t potential_high_byte = page_3_to_6[p4_offset + 2];
-      uint8_t potential_low_byte = page_3_to_6[p4_offset + 3];
-      ESP_LOGD(TAG, "Potential length bytes: high=0x%02X, low=0x%02X", potential_high_byte, potential_low_byte);
-      
-      // Key insight: If the byte after 0xFF is 0x03, it's likely the start of a new TLV,
-      // not part of extended length format. Extended length format: 03 FF HH LL
-      // But pattern like "03 FF 03 xx" suggests: TLV1=(03 FF) TLV2=(03 xx)
-      if (potential_high_byte == 0x03) {
-        ESP_LOGD(TAG, "Byte after 0xFF is 0x03 - found second TLV, not extended length");
-        
-        // In this case, we likely have two TLVs: "03 FF" and "03 xx"
-        // The first TLV (03 FF) with 255 bytes is probably invalid or too large
-        // Let's try to use the second TLV (03 xx) instead
-        uint8_t second_tlv_length = potential_low_byte;
-        ESP_LOGD(TAG, "Second TLV length: %u bytes", second_tlv_length);
-        
-        // If the second TLV length seems more reasonable, use it
-        if (second_tlv_length > 0 && second_tlv_length <= 100) {
-          ESP_LOGD(TAG, "Using second TLV (length %u) instead of first TLV (255)", second_tlv_length);
-          message_length = second_tlv_length;
-          message_start_index = 4;  // Skip "03 FF 03", start at the data after the second TLV length
-        } else {
-          ESP_LOGD(TAG, "Second TLV length %u also seems invalid, falling back to first TLV (255)", second_tlv_length);
-          message_length = 255;
-          message_start_index = 2;
-        }
-      } else {
-        // Check if extended length makes sense
-        uint16_t potential_length = potential_high_byte * 256 + potential_low_byte;
-        
-        // Extended length should only be used for lengths > 254
-        if (potential_length > 254 && potential_length <= 924) {
-          ESP_LOGD(TAG, "Using extended length format: %u bytes", potential_length);
-          message_length = potential_length;
-          message_start_index = 4;
-        } else {
-          ESP_LOGD(TAG, "Extended length %u is invalid, treating as regular length (255)", potential_length);
-          message_length = 255;
-          message_start_index = 2;
-        }
-      }
-      
-      // Additional sanity check: if the chosen length seems too large, warn about it
-      if (message_length > 100) {
-        ESP_LOGW(TAG, "Length %u seems large, tag may have corrupted length field", message_length);
-      }
-      
-      ESP_LOGD(TAG, "MALOG: find_mifare_ultralight_ndef_: TRUE1b, length=%u", message_length);
-	} else {
-      // fixed length: byte 0 = 0x03; byte 1 = Length
-	  message_length = page_3_to_6[p4_offset + 1];
-      message_start_index = 2;
-      ESP_LOGD(TAG, "MALOG: find_mifare_ultralight_ndef_: TRUE1b, length=%u", message_length);
+  // lengths above 0xFE only come from the three byte form, "03 FF HH LL"
+  if (message_length > 0xFE) {
+    if ((message_length >> 8) == nfc::TLV_NDEF_MESSAGE && (message_length & 0xFF) != 0 &&
+        (message_length & 0xFF) <= PN532_ULTRALIGHT_MAX_NESTED_LENGTH) {
+      // "03 FF 03 LL", as some water meters write it: a second short NDEF TLV where the long length should be
+      ESP_LOGD(TAG, "Using nested TLV of %" PRIu32 " bytes", message_length & 0xFF);
+      message_length &= 0xFF;
+    } else if (message_length > this->read_mifare_ultralight_capacity_()) {
+      ESP_LOGW(TAG, "Length %" PRIu32 " exceeds the tag's capacity, reading it as a 255 byte TLV", message_length);
+      message_start -= 2;
+      message_length = 0xFF;
     }
-    return true;
-  } else if (page_3_to_6[p4_offset + 5] == 0x03) {
-    if (page_3_to_6.size() < p4_offset + 7) {
-      ESP_LOGE(TAG, "Not enough data for NDEF TLV at offset 5");
+  }
+  return true;
+}
+
+bool PN532::find_mifare_ultralight_record_(nfc::TagMemory &memory, const uint32_t message_start,
+                                           const uint32_t message_length, uint32_t &record_start,
+                                           uint32_t &record_length) {
+  uint8_t header[3];  // flags/TNF, type length, payload length of a short record
+  const uint32_t message_end = message_start + message_length;
+  // a well formed message opens with its first record
+  if (!memory.read(message_start, header, sizeof(header)) || (header[0] & 0x80)) {
+    return false;
+  }
+
+  // some meters pad the message ahead of the record; take the first thing that looks like a short record
+  for (uint32_t i = message_start + 1; i + sizeof(header) <= message_end; i++) {
+    if (!memory.read(i, header, sizeof(header))) {
       return false;
     }
-    message_length = page_3_to_6[p4_offset + 6];
-    message_start_index = 7;
-    ESP_LOGD(TAG, "MALOG: find_mifare_ultralight_ndef_: TRUE2");
-    return true;
+    if ((header[0] & 0x07) <= 0x06 && (header[0] & 0x10) && header[1] <= 8 && header[2] > 0 &&
+        header[2] < PN532_ULTRALIGHT_MAX_PADDED_PAYLOAD) {
+      record_start = i;
+      // the record may run past the TLV; follow it as far as the tag goes
+      record_length = std::max<uint32_t>(message_end - i, sizeof(header) + header[1] + header[2]);
+      record_length = std::min<uint32_t>(record_length, memory.size() - i);
+      return true;
+    }
   }
-  ESP_LOGD(TAG, "MALOG: find_mifare_ultralight_ndef_: FALSE");
   return false;
 }
 
+#ifdef USE_PN532_WRITE
 bool PN532::write_mifare_ultralight_tag_(std::vector<uint8_t> &uid, nfc::NdefMessage *message) {
+  this->ultralight_sector_ = 0;
+  if (!this->authenticate_mifare_ultralight_(uid)) {
+    return false;
+  }
+  const bool written = this->write_mifare_ultralight_message_(message);
+  this->reset_mifare_ultralight_sector_();
+  return written;
+}
+
+bool PN532::write_mifare_ultralight_message_(nfc::NdefMessage *message) {
   uint32_t capacity = this->read_mifare_ultralight_capacity_();
 
   auto encoded = message->encode();
@@ -661,6 +360,10 @@ bool PN532::write_mifare_ultralight_tag_(std::vector<uint8_t> &uid, nfc::NdefMes
     ESP_LOGE(TAG, "Message length exceeds tag capacity %" PRIu32 " > %" PRIu32, buffer_length, capacity);
     return false;
   }
+  if (buffer_length > this->get_mifare_ultralight_unprotected_size_(false)) {
+    ESP_LOGE(TAG, "Message runs into write protected pages and no password is configured for this tag");
+    return false;
+  }
 
   encoded.insert(encoded.begin(), 0x03);
   if (message_length < 255) {
@@ -674,40 +377,46 @@ bool PN532::write_mifare_ultralight_tag_(std::vector<uint8_t> &uid, nfc::NdefMes
 
   encoded.resize(buffer_length, 0);
 
-  uint32_t index = 0;
-  uint8_t current_page = nfc::MIFARE_ULTRALIGHT_DATA_START_PAGE;
-
-  while (index < buffer_length) {
+  for (uint32_t index = 0; index < buffer_length; index += nfc::MIFARE_ULTRALIGHT_PAGE_SIZE) {
     std::vector<uint8_t> data(encoded.begin() + index, encoded.begin() + index + nfc::MIFARE_ULTRALIGHT_PAGE_SIZE);
-    if (!this->write_mifare_ultralight_page_(current_page, data)) {
+    if (!this->write_mifare_ultralight_page_(data_page(index / nfc::MIFARE_ULTRALIGHT_PAGE_SIZE), data)) {
       return false;
     }
-    index += nfc::MIFARE_ULTRALIGHT_PAGE_SIZE;
-    current_page++;
   }
   return true;
 }
 
-bool PN532::clean_mifare_ultralight_() {
-  uint32_t capacity = this->read_mifare_ultralight_capacity_();
-  uint8_t pages = (capacity / nfc::MIFARE_ULTRALIGHT_PAGE_SIZE) + nfc::MIFARE_ULTRALIGHT_DATA_START_PAGE;
+bool PN532::clean_mifare_ultralight_(std::vector<uint8_t> &uid) {
+  this->ultralight_sector_ = 0;
+  if (!this->authenticate_mifare_ultralight_(uid)) {
+    return false;
+  }
+  const uint32_t capacity = this->read_mifare_ultralight_capacity_();
+  if (capacity > this->get_mifare_ultralight_unprotected_size_(false)) {
+    ESP_LOGE(TAG, "Data area is write protected and no password is configured for this tag");
+    return false;
+  }
+  const uint32_t pages = capacity / nfc::MIFARE_ULTRALIGHT_PAGE_SIZE;
 
   std::vector<uint8_t> blank_data = {0x00, 0x00, 0x00, 0x00};
 
-  for (int i = nfc::MIFARE_ULTRALIGHT_DATA_START_PAGE; i < pages; i++) {
-    if (!this->write_mifare_ultralight_page_(i, blank_data)) {
-      return false;
-    }
+  bool cleaned = true;
+  for (uint32_t i = 0; i < pages && cleaned; i++) {
+    cleaned = this->write_mifare_ultralight_page_(data_page(i), blank_data);
   }
-  return true;
+  this->reset_mifare_ultralight_sector_();
+  return cleaned;
 }
 
-bool PN532::write_mifare_ultralight_page_(uint8_t page_num, std::vector<uint8_t> &write_data) {
+bool PN532::write_mifare_ultralight_page_(const uint16_t page_num, std::vector<uint8_t> &write_data) {
+  if (!this->select_mifare_ultralight_sector_(page_num / nfc::MIFARE_ULTRALIGHT_SECTOR_PAGES)) {
+    return false;
+  }
   std::vector<uint8_t> data({
       PN532_COMMAND_INDATAEXCHANGE,
       0x01,  // One card
       nfc::MIFARE_CMD_WRITE_ULTRALIGHT,
-      page_num,
+      uint8_t(page_num % nfc::MIFARE_ULTRALIGHT_SECTOR_PAGES),
   });
   data.insert(data.end(), write_data.begin(), write_data.end());
   if (!this->write_command_(data)) {
@@ -723,6 +432,9 @@ bool PN532::write_mifare_ultralight_page_(uint8_t page_num, std::vector<uint8_t>
 
   return true;
 }
+#endif  // USE_PN532_WRITE
+
+#endif  // USE_PN532_MIFARE_ULTRALIGHT
 
 }  // namespace pn532
 }  // namespace esphome
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <memory>
+#include <cinttypes>
+
+#include "pn532.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace pn532 {
+
+#ifdef USE_PN532_TYPE1
+
+static const char *const TAG = "pn532.type1";
+
+// the data area is addressed from right after the capability container, in units of this many bytes; they all
+// lie on one side of the reserved blocks
+static const uint8_t UNIT_SIZE = 4;
+
+/// Memory address of byte `address` of the data area
+static uint32_t data_address(const uint32_t address) {
+  const uint32_t physical = nfc::TYPE_1_DATA_START + address;
+  return physical < nfc::TYPE_1_RESERVED_START ? physical : physical + nfc::TYPE_1_RESERVED_SIZE;
+}
+
+std::unique_ptr<nfc::NfcTag> PN532::read_type1_tag_(std::vector<uint8_t> &uid) {
+  // one READALL brings in the whole of a static memory tag, and the first segment of a dynamic one
+  std::vector<uint8_t> image;
+  if (!this->read_type1_all_(image)) {
+    ESP_LOGW(TAG, "READALL failed");
+    this->read_telemetry_.read_failed = true;
+    return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_1);
+  }
+  const uint8_t hr0 = image[0];
+  image.erase(image.begin(), image.begin() + nfc::TYPE_1_HR_SIZE);
+  ESP_LOGVV(TAG, "HR0 %02X, memory: %s", hr0, nfc::format_bytes(image).c_str());
+
+  const uint8_t *cc = &image[nfc::TYPE_1_CC_OFFSET];
+  if ((hr0 & nfc::TYPE_1_HR0_NDEF_MASK) != nfc::TYPE_1_HR0_NDEF || cc[0] != nfc::TYPE_1_CC_MAGIC) {
+    ESP_LOGV(TAG, "Not NDEF formatted");
+    return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_1);
+  }
+  if ((cc[nfc::TYPE_1_CC_RWA_OFFSET] >> 4) != 0x00) {
+    ESP_LOGW(TAG, "NDEF data is not readable");
+    return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_1);
+  }
+
+  // the data area ends with the memory, or with the reserved blocks on a static memory tag
+  uint32_t memory_size = nfc::TYPE_1_BLOCK_SIZE * (cc[nfc::TYPE_1_CC_TMS_OFFSET] + 1U);
+  if (hr0 == nfc::TYPE_1_HR0_STATIC) {
+    memory_size = std::min<uint32_t>(memory_size, nfc::TYPE_1_RESERVED_START);
+  }
+  uint32_t size = 0;
+  if (memory_size > nfc::TYPE_1_RESERVED_START + nfc::TYPE_1_RESERVED_SIZE) {
+    size = memory_size - nfc::TYPE_1_DATA_START - nfc::TYPE_1_RESERVED_SIZE;
+  } else if (memory_size > nfc::TYPE_1_DATA_START) {
+    size = std::min<uint32_t>(memory_size, nfc::TYPE_1_RESERVED_START) - nfc::TYPE_1_DATA_START;
+  }
+  size -= size % UNIT_SIZE;
+  image.resize(std::max<size_t>(image.size(), data_address(size)));
+
+  // further segments are fetched with RSEG, each once, when the decoder gets to them; it may skip some
+  uint16_t segments = 1;  // bit n: segment n is in `image`
+  nfc::TagMemory memory(size, UNIT_SIZE,
+                        [this, &image, &segments](uint32_t unit, std::vector<uint8_t> &data) {
+                          const uint32_t address = data_address(unit * UNIT_SIZE);
+                          const uint8_t segment = address / nfc::TYPE_1_SEGMENT_SIZE;
+                          if (!(segments & (1 << segment))) {
+                            std::vector<uint8_t> fetched;
+                            if (!this->read_type1_segment_(segment, fetched)) {
+                              ESP_LOGE(TAG, "Error reading segment %u", segment);
+                              this->read_telemetry_.read_failed = true;
+                              return false;
+                            }
+                            std::copy(fetched.begin(), fetched.end(),
+                                      image.begin() + segment * nfc::TYPE_1_SEGMENT_SIZE);
+                            segments |= 1 << segment;
+                          }
+                          data.insert(data.end(), image.begin() + address, image.begin() + address + UNIT_SIZE);
+                          return true;
+                        });
+
+  uint32_t message_start;
+  uint32_t message_length;
+  if (!nfc::find_ndef_tlv(memory, message_start, message_length)) {
+    ESP_LOGW(TAG, "Couldn't find NDEF message");
+    return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_1);
+  }
+  if (message_length == 0) {
+    return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_1);
+  }
+
+  auto message = this->decode_ndef_message_(memory, message_start, message_length);
+  if (message == nullptr) {
+    return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_1);
+  }
+  ESP_LOGVV(TAG, "Decoded %" PRIu32 " byte NDEF message from %u segments", message_length,
+            __builtin_popcount(segments));
+  return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_1, std::move(message));
+}
+
+bool PN532::read_type1_all_(std::vector<uint8_t> &data) {
+  // the PN532 adds the target's UID to Jewel commands itself
+  if (!this->in_data_exchange_({nfc::TYPE_1_CMD_READALL, 0x00, 0x00}, data) ||
+      data.size() < nfc::TYPE_1_HR_SIZE + nfc::TYPE_1_READALL_SIZE) {
+    return false;
+  }
+  data.resize(nfc::TYPE_1_HR_SIZE + nfc::TYPE_1_READALL_SIZE);
+  this->count_read_(nfc::TYPE_1_READALL_SIZE);
+  return true;
+}
+
+bool PN532::read_type1_segment_(const uint8_t segment, std::vector<uint8_t> &data) {
+  std::vector<uint8_t> response;
+  // ADDS carries the segment in its upper nibble; the answer repeats it ahead of the data
+  if (!this->in_data_exchange_({nfc::TYPE_1_CMD_RSEG, uint8_t(segment << 4), 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                0x00, 0x00},
+                               response) ||
+      response.size() < 1U + nfc::TYPE_1_SEGMENT_SIZE) {
+    return false;
+  }
+  data.insert(data.end(), response.begin() + 1, response.begin() + 1 + nfc::TYPE_1_SEGMENT_SIZE);
+  this->count_read_(nfc::TYPE_1_SEGMENT_SIZE);
+  return true;
+}
+
+#endif  // USE_PN532_TYPE1
+
+}  // namespace pn532
+}  // namespace esphome
@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <memory>
+#include <cinttypes>
+
+#include "pn532.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace pn532 {
+
+static const char *const TAG = "pn532.type4";
+
+#ifdef USE_PN532_TYPE4
+std::unique_ptr<nfc::NfcTag> PN532::read_type4_tag_(std::vector<uint8_t> &uid) {
+  if (!this->select_type4_(nfc::TYPE_4_SELECT_BY_NAME, nfc::TYPE_4_NDEF_APP_ID, sizeof(nfc::TYPE_4_NDEF_APP_ID))) {
+    ESP_LOGV(TAG, "No NDEF application");
+    return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_4);
+  }
+
+  const uint8_t cc_file[] = {nfc::TYPE_4_CC_FILE_ID >> 8, nfc::TYPE_4_CC_FILE_ID & 0xFF};
+  std::vector<uint8_t> cc;
+  if (!this->select_type4_(nfc::TYPE_4_SELECT_BY_ID, cc_file, sizeof(cc_file)) ||
+      !this->read_type4_binary_(0, nfc::TYPE_4_CC_LENGTH, nfc::TYPE_4_CC_LENGTH, cc)) {
+    ESP_LOGW(TAG, "Failed to read capability container");
+    this->read_telemetry_.read_failed = true;
+    return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_4);
+  }
+  ESP_LOGVV(TAG, "Capability container: %s", nfc::format_bytes(cc).c_str());
+
+  if (cc[nfc::TYPE_4_CC_NDEF_TLV_OFFSET] != nfc::TYPE_4_NDEF_FILE_CONTROL_TLV ||
+      cc[nfc::TYPE_4_CC_NDEF_READ_ACCESS_OFFSET] != 0x00) {
+    ESP_LOGW(TAG, "No readable NDEF file");
+    return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_4);
+  }
+  // MLe is the most the tag will return for one READ BINARY; ask for that much every time, as far as a normal
+  // PN532 frame allows
+  const uint16_t mle = (cc[nfc::TYPE_4_CC_MLE_OFFSET] << 8) | cc[nfc::TYPE_4_CC_MLE_OFFSET + 1];
+  const uint8_t max_le = std::min<uint16_t>(mle, std::min(nfc::TYPE_4_MAX_LE, PN532_TYPE4_MAX_LE));
+  if (max_le == 0) {
+    ESP_LOGW(TAG, "Invalid MLe");
+    return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_4);
+  }
+
+  std::vector<uint8_t> nlen;
+  if (!this->select_type4_(nfc::TYPE_4_SELECT_BY_ID, &cc[nfc::TYPE_4_CC_NDEF_FILE_ID_OFFSET], 2) ||
+      !this->read_type4_binary_(0, nfc::TYPE_4_NLEN_SIZE, max_le, nlen)) {
+    ESP_LOGW(TAG, "Failed to read NDEF file");
+    this->read_telemetry_.read_failed = true;
+    return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_4);
+  }
+
+  const uint16_t message_length = (nlen[0] << 8) | nlen[1];
+  ESP_LOGVV(TAG, "NDEF message length: %u, MLe: %u", message_length, mle);
+  if (message_length == 0) {
+    return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_4);
+  }
+
+  // the NDEF file stays selected; each READ BINARY fetches the next MLe bytes the decoder asks for
+  nfc::TagMemory memory(message_length, max_le,
+                        [this, max_le, message_length](uint32_t unit, std::vector<uint8_t> &data) {
+                          const uint16_t offset = unit * max_le;
+                          if (!this->read_type4_binary_(nfc::TYPE_4_NLEN_SIZE + offset,
+                                                        std::min<uint16_t>(max_le, message_length - offset), max_le,
+                                                        data)) {
+                            this->read_telemetry_.read_failed = true;
+                            return false;
+                          }
+                          return true;
+                        });
+  auto message = this->decode_ndef_message_(memory, 0, message_length);
+  if (message == nullptr) {
+    return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_4);
+  }
+  ESP_LOGVV(TAG, "Decoded NDEF message with %" PRIu32 " READ BINARY commands", memory.get_fetch_count());
+  return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_4, std::move(message));
+}
+
+bool PN532::select_type4_(const uint8_t p1, const uint8_t *id, const uint8_t id_length) {
+  // the NDEF application is selected with Le present; files are selected without asking for FCI
+  const bool by_name = p1 == nfc::TYPE_4_SELECT_BY_NAME;
+  std::vector<uint8_t> apdu = {nfc::TYPE_4_CLA, nfc::TYPE_4_INS_SELECT, p1,
+                               uint8_t(by_name ? 0x00 : nfc::TYPE_4_SELECT_FIRST_NO_FCI), id_length};
+  apdu.insert(apdu.end(), id, id + id_length);
+  if (by_name) {
+    apdu.push_back(0x00);
+  }
+
+  std::vector<uint8_t> response;
+  return this->transceive_apdu_(apdu, response);
+}
+
+bool PN532::read_type4_binary_(const uint16_t offset, const uint16_t length, const uint8_t max_le,
+                               std::vector<uint8_t> &data) {
+  std::vector<uint8_t> response;
+  data.reserve(data.size() + length);
+
+  for (uint16_t done = 0; done < length;) {
+    const uint16_t position = offset + done;
+    const uint8_t le = std::min<uint16_t>(length - done, max_le);
+    if (!this->transceive_apdu_({nfc::TYPE_4_CLA, nfc::TYPE_4_INS_READ_BINARY, uint8_t(position >> 8),
+                                 uint8_t(position & 0xFF), le},
+                                response) ||
+        response.empty()) {
+      ESP_LOGE(TAG, "Error reading %u bytes at offset %u", le, position);
+      return false;
+    }
+    const uint16_t received = std::min<uint16_t>(response.size(), length - done);
+    this->count_read_(received);
+    data.insert(data.end(), response.begin(), response.begin() + received);
+    done += received;
+  }
+
+  ESP_LOGVV(TAG, "Data read: %s", nfc::format_bytes(data).c_str());
+
+  return true;
+}
+
+bool PN532::transceive_apdu_(const std::vector<uint8_t> &apdu, std::vector<uint8_t> &response) {
+  if (!this->in_data_exchange_(apdu, response) || response.size() < 2) {
+    return false;
+  }
+
+  const uint8_t sw1 = response[response.size() - 2];
+  const uint8_t sw2 = response[response.size() - 1];
+  response.resize(response.size() - 2);
+  if (sw1 != nfc::TYPE_4_SW1_OK || sw2 != nfc::TYPE_4_SW2_OK) {
+    ESP_LOGV(TAG, "APDU %02X %02X failed with status %02X %02X", apdu[0], apdu[1], sw1, sw2);
+    return false;
+  }
+  return true;
+}
+
+#endif  // USE_PN532_TYPE4
+
+// also used by the FeliCa reader, so compiled in whenever either of them is
+bool PN532::in_data_exchange_(const std::vector<uint8_t> &data, std::vector<uint8_t> &response) {
+  if (this->in_data_exchange_chained_(data, response)) {
+    return true;
+  }
+  if (this->bit_rate_ == PN532_BIT_RATE_106) {
+    return false;
+  }
+
+  ESP_LOGW(TAG, "Exchange failed at bit rate %u, falling back to 106 kbit/s", this->bit_rate_);
+  this->read_telemetry_.retries++;
+  this->remember_bit_rate_(this->bit_rate_uid_, PN532_BIT_RATE_106);
+  if (!this->set_bit_rate_(PN532_BIT_RATE_106, PN532_BIT_RATE_106)) {
+    return false;
+  }
+  return this->in_data_exchange_chained_(data, response);
+}
+
+bool PN532::in_data_exchange_chained_(const std::vector<uint8_t> &data, std::vector<uint8_t> &response) {
+  std::vector<uint8_t> frame;
+  std::vector<uint8_t> read;
+  size_t sent = 0;
+
+  // anything that doesn't fit one frame goes out in pieces, each but the last flagged with MI
+  do {
+    const size_t chunk = std::min<size_t>(data.size() - sent, PN532_INDATAEXCHANGE_MAX_DATA);
+    const bool more = sent + chunk < data.size();
+    frame = {PN532_COMMAND_INDATAEXCHANGE, uint8_t(0x01 | (more ? PN532_INDATAEXCHANGE_MI : 0))};
+    frame.insert(frame.end(), data.begin() + sent, data.begin() + sent + chunk);
+    sent += chunk;
+
+    if (!this->write_command_(frame) || !this->read_response(PN532_COMMAND_INDATAEXCHANGE, read) || read.empty() ||
+        (read[0] & PN532_INDATAEXCHANGE_ERROR_MASK) != 0x00) {
+      return false;
+    }
+  } while (sent < data.size());
+
+  response.assign(read.begin() + 1, read.end());
+  // the PN532 sets MI while it is holding more of the target's answer; an empty exchange fetches the next part
+  while (read[0] & PN532_INDATAEXCHANGE_MI) {
+    if (!this->write_command_({PN532_COMMAND_INDATAEXCHANGE, 0x01}) ||
+        !this->read_response(PN532_COMMAND_INDATAEXCHANGE, read) || read.empty() ||
+        (read[0] & PN532_INDATAEXCHANGE_ERROR_MASK) != 0x00) {
+      return false;
+    }
+    response.insert(response.end(), read.begin() + 1, read.end());
+  }
+
+  return true;
+}
+
+#ifdef USE_PN532_TYPE4
+void PN532::negotiate_bit_rate_(const std::vector<uint8_t> &uid, const std::vector<uint8_t> &ats) {
+  this->bit_rate_uid_ = uid;
+  for (auto &memory : this->bit_rate_memory_) {
+    if (memory.uid == uid) {
+      if (memory.bit_rate != PN532_BIT_RATE_106 && !this->set_bit_rate_(memory.bit_rate, memory.bit_rate)) {
+        memory.bit_rate = PN532_BIT_RATE_106;
+      }
+      return;
+    }
+  }
+
+  if (ats.size() <= nfc::ISO14443_4_ATS_TA1_OFFSET ||
+      !(ats[nfc::ISO14443_4_ATS_T0_OFFSET] & nfc::ISO14443_4_ATS_T0_TA1_PRESENT)) {
+    this->remember_bit_rate_(uid, PN532_BIT_RATE_106);
+    return;
+  }
+
+  const uint8_t ta1 = ats[nfc::ISO14443_4_ATS_TA1_OFFSET];
+  uint8_t bit_rate_it = PN532_BIT_RATE_106;
+  uint8_t bit_rate_ti = PN532_BIT_RATE_106;
+  if (ta1 & nfc::ISO14443_4_TA1_DR_424) {
+    bit_rate_it = PN532_BIT_RATE_424;
+  } else if (ta1 & nfc::ISO14443_4_TA1_DR_212) {
+    bit_rate_it = PN532_BIT_RATE_212;
+  }
+  if (ta1 & nfc::ISO14443_4_TA1_DS_424) {
+    bit_rate_ti = PN532_BIT_RATE_424;
+  } else if (ta1 & nfc::ISO14443_4_TA1_DS_212) {
+    bit_rate_ti = PN532_BIT_RATE_212;
+  }
+  if (ta1 & nfc::ISO14443_4_TA1_SAME_D) {
+    bit_rate_it = bit_rate_ti = std::min(bit_rate_it, bit_rate_ti);
+  }
+  // the memory only holds one rate per tag, so asymmetric links are remembered by their slower direction
+  const uint8_t bit_rate = std::min(bit_rate_it, bit_rate_ti);
+
+  if (std::max(bit_rate_it, bit_rate_ti) == PN532_BIT_RATE_106 || this->set_bit_rate_(bit_rate_it, bit_rate_ti)) {
+    this->remember_bit_rate_(uid, bit_rate);
+  } else {
+    this->remember_bit_rate_(uid, PN532_BIT_RATE_106);
+  }
+}
+
+#endif  // USE_PN532_TYPE4
+
+bool PN532::set_bit_rate_(const uint8_t bit_rate_it, const uint8_t bit_rate_ti) {
+  std::vector<uint8_t> response;
+  if (!this->write_command_({PN532_COMMAND_INPSL, 0x01, bit_rate_it, bit_rate_ti}) ||
+      !this->read_response(PN532_COMMAND_INPSL, response) || response.empty() ||
+      (response[0] & PN532_INDATAEXCHANGE_ERROR_MASK) != 0x00) {
+    ESP_LOGW(TAG, "InPSL to %u/%u failed", bit_rate_it, bit_rate_ti);
+    return false;
+  }
+  ESP_LOGV(TAG, "Bit rate set to %u/%u", bit_rate_it, bit_rate_ti);
+  this->bit_rate_ = std::max(bit_rate_it, bit_rate_ti);
+  return true;
+}
+
+void PN532::remember_bit_rate_(const std::vector<uint8_t> &uid, const uint8_t bit_rate) {
+  for (auto &memory : this->bit_rate_memory_) {
+    if (memory.uid == uid) {
+      memory.bit_rate = bit_rate;
+      return;
+    }
+  }
+  if (this->bit_rate_memory_.size() >= PN532_MAX_BIT_RATE_MEMORY) {
+    this->bit_rate_memory_.erase(this->bit_rate_memory_.begin());
+  }
+  this->bit_rate_memory_.push_back({uid, bit_rate});
+}
+
+}  // namespace pn532
+}  // namespace esphome
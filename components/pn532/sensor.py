@@ -0,0 +1,157 @@
+import esphome.codegen as cg
+from esphome.components import sensor
+import esphome.config_validation as cv
+from esphome.const import (
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+    UNIT_MILLISECOND,
+    UNIT_PERCENT,
+)
+
+from . import CONF_PN532_ID, PN532, POLLING_TECHNOLOGIES, pn532_ns
+
+DEPENDENCIES = ["pn532"]
+
+CONF_BYTES_READ = "bytes_read"
+CONF_EXCHANGES = "exchanges"
+CONF_NDEF_SIZE = "ndef_size"
+CONF_OVER_READ_RATIO = "over_read_ratio"
+CONF_READ_DURATION = "read_duration"
+CONF_READ_SIZE = "read_size"
+CONF_READ_SUCCESS_RATE = "read_success_rate"
+CONF_READS = "reads"
+CONF_RETRIES = "retries"
+
+UNIT_BYTES = "B"
+
+PN532Operation = pn532_ns.enum("PN532Operation")
+MEMORY_OPERATIONS = {
+    "read": PN532Operation.OPERATION_READ,
+    "write": PN532Operation.OPERATION_WRITE,
+    "triggers": PN532Operation.OPERATION_TRIGGERS,
+}
+PN532MemoryMetric = pn532_ns.enum("PN532MemoryMetric")
+MEMORY_METRICS = {
+    "heap_peak": (PN532MemoryMetric.MEMORY_HEAP_PEAK, "mdi:memory"),
+    "largest_free_block": (
+        PN532MemoryMetric.MEMORY_LARGEST_FREE_BLOCK,
+        "mdi:memory",
+    ),
+    "stack_free": (PN532MemoryMetric.MEMORY_STACK_FREE, "mdi:layers-outline"),
+}
+# <operation>_<metric>, e.g. read_heap_peak: the worst seen since boot, published
+# after every operation of that kind
+MEMORY_SENSORS = {
+    f"{operation}_{metric}": (operation, metric)
+    for operation in MEMORY_OPERATIONS
+    for metric in MEMORY_METRICS
+}
+PN532PollingMetric = pn532_ns.enum("PN532PollingMetric")
+POLLING_METRICS = {
+    "polls": (PN532PollingMetric.POLLING_POLLS, "mdi:radar"),
+    "hits": (PN532PollingMetric.POLLING_HITS, "mdi:target"),
+}
+# <technology>_<metric>, e.g. iso14443a_hits: counts since boot, published every
+# PN532_POLL_STATS_LOG_CYCLES polling cycles
+POLLING_SENSORS = {
+    f"{technology}_{metric}": (technology, metric)
+    for technology in POLLING_TECHNOLOGIES
+    for metric in POLLING_METRICS
+}
+
+
+def _telemetry_schema(unit=None, icon=None, accuracy_decimals=0):
+    return sensor.sensor_schema(
+        unit_of_measurement=unit,
+        icon=icon,
+        accuracy_decimals=accuracy_decimals,
+        state_class=STATE_CLASS_MEASUREMENT,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    )
+
+
+# all of these are published once per tag read, see PN532::finish_read_telemetry_()
+TELEMETRY_SENSORS = {
+    CONF_READ_DURATION: (
+        "set_read_duration_sensor",
+        _telemetry_schema(UNIT_MILLISECOND, "mdi:timer-outline"),
+    ),
+    CONF_BYTES_READ: (
+        "set_bytes_read_sensor",
+        _telemetry_schema(UNIT_BYTES, "mdi:download"),
+    ),
+    CONF_NDEF_SIZE: (
+        "set_ndef_size_sensor",
+        _telemetry_schema(UNIT_BYTES, "mdi:nfc"),
+    ),
+    CONF_OVER_READ_RATIO: (
+        "set_over_read_ratio_sensor",
+        _telemetry_schema(icon="mdi:division", accuracy_decimals=2),
+    ),
+    CONF_READS: ("set_reads_sensor", _telemetry_schema(icon="mdi:counter")),
+    CONF_READ_SIZE: (
+        "set_read_size_sensor",
+        _telemetry_schema(UNIT_BYTES, "mdi:arrow-expand-horizontal"),
+    ),
+    CONF_EXCHANGES: (
+        "set_exchanges_sensor",
+        _telemetry_schema(icon="mdi:swap-horizontal"),
+    ),
+    CONF_RETRIES: ("set_retries_sensor", _telemetry_schema(icon="mdi:replay")),
+    CONF_READ_SUCCESS_RATE: (
+        "set_read_success_rate_sensor",
+        _telemetry_schema(UNIT_PERCENT, "mdi:check-circle-outline", 1),
+    ),
+}
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(CONF_PN532_ID): cv.use_id(PN532),
+        **{cv.Optional(key): schema for key, (_, schema) in TELEMETRY_SENSORS.items()},
+        **{
+            cv.Optional(key): sensor.sensor_schema(
+                icon=POLLING_METRICS[metric][1],
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            )
+            for key, (_, metric) in POLLING_SENSORS.items()
+        },
+        # heap_caps and the FreeRTOS stack high-water mark are only there on ESP32
+        **{
+            cv.Optional(key): cv.All(
+                _telemetry_schema(UNIT_BYTES, MEMORY_METRICS[metric][1]),
+                cv.only_on_esp32,
+            )
+            for key, (_, metric) in MEMORY_SENSORS.items()
+        },
+    }
+)
+
+
+async def to_code(config):
+    hub = await cg.get_variable(config[CONF_PN532_ID])
+    for key, (setter, _) in TELEMETRY_SENSORS.items():
+        if key in config:
+            sens = await sensor.new_sensor(config[key])
+            cg.add(getattr(hub, setter)(sens))
+
+    for key, (technology, metric) in POLLING_SENSORS.items():
+        if key in config:
+            sens = await sensor.new_sensor(config[key])
+            cg.add(
+                hub.set_polling_sensor(
+                    POLLING_TECHNOLOGIES[technology], POLLING_METRICS[metric][0], sens
+                )
+            )
+
+    for key, (operation, metric) in MEMORY_SENSORS.items():
+        if key in config:
+            cg.add_define("USE_PN532_MEMORY_STATS")
+            sens = await sensor.new_sensor(config[key])
+            cg.add(
+                hub.set_memory_sensor(
+                    MEMORY_OPERATIONS[operation], MEMORY_METRICS[metric][0], sens
+                )
+            )
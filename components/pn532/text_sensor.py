@@ -0,0 +1,28 @@
+import esphome.codegen as cg
+from esphome.components import text_sensor
+import esphome.config_validation as cv
+from esphome.const import ENTITY_CATEGORY_DIAGNOSTIC
+
+from . import CONF_PN532_ID, PN532
+
+DEPENDENCIES = ["pn532"]
+
+CONF_READ_OUTCOME = "read_outcome"
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(CONF_PN532_ID): cv.use_id(PN532),
+        # complete, partial or failed, published once per tag read
+        cv.Optional(CONF_READ_OUTCOME): text_sensor.text_sensor_schema(
+            icon="mdi:nfc-search-variant",
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+    }
+)
+
+
+async def to_code(config):
+    hub = await cg.get_variable(config[CONF_PN532_ID])
+    if CONF_READ_OUTCOME in config:
+        sens = await text_sensor.new_text_sensor(config[CONF_READ_OUTCOME])
+        cg.add(hub.set_read_outcome_text_sensor(sens))
@@ -16,7 +16,8 @@ CONFIG_SCHEMA = cv.All(
         {
             cv.GenerateID(): cv.declare_id(PN532I2C),
         }
-    ).extend(i2c.i2c_device_schema(0x24))
+    ).extend(i2c.i2c_device_schema(0x24)),
+    pn532.validate_pn532,
 )
 
 
@@ -2,6 +2,8 @@
 #include "esphome/core/log.h"
 #include "esphome/core/hal.h"
 
+#include <cinttypes>
+
 // Based on:
 // - https://cdn-shop.adafruit.com/datasheets/PN532C106_Application+Note_v1.2.pdf
 // - https://www.nxp.com/docs/en/nxp/application-notes/AN133910.pdf
@@ -12,6 +14,11 @@ namespace pn532_i2c {
 
 static const char *const TAG = "pn532_i2c";
 
+// same limit as PN532::read_ready_()
+static const uint32_t PN532_I2C_READY_TIMEOUT = 100;
+// frame bytes read for a response before its length is known; InListPassiveTarget and 16 byte tag reads fit
+static const uint16_t PN532_I2C_RESPONSE_FIRST_READ = 32;
+
 bool PN532I2C::is_read_ready() {
   uint8_t ready;
   if (!this->read_bytes_raw(&ready, 1)) {
@@ -24,30 +31,60 @@ bool PN532I2C::write_data(const std::vector<uint8_t> &data) {
   return this->write(data.data(), data.size()) == i2c::ERROR_OK;
 }
 
-bool PN532I2C::read_data(std::vector<uint8_t> &data, uint8_t len) {
-  delay(1);
-
-  if (this->read_ready_(true) != pn532::PN532ReadReady::READY) {
-    return false;
+bool PN532I2C::read_data(std::vector<uint8_t> &data, uint16_t len) {
+  // the PN532 is polled with single status byte reads while it works, so the bus is not kept busy with frame reads;
+  // every read starts with that status byte, so once it says ready, status and frame are read in one go
+  const uint32_t start = micros();
+  uint16_t polls = 1;
+  while (!this->is_read_ready()) {
+    if (micros() - start > PN532_I2C_READY_TIMEOUT * 1000) {
+      ESP_LOGV(TAG, "Timed out waiting for readiness from PN532!");
+      this->clear_read_ready_();
+      return false;
+    }
+    yield();
+    polls++;
   }
-
   data.resize(len + 1);
-  this->read_bytes_raw(data.data(), len + 1);
+  const bool read = this->read(data.data(), data.size()) == i2c::ERROR_OK && data[0] == 0x01;
+  this->clear_read_ready_();
+  if (!read) {
+    ESP_LOGV(TAG, "Reading %u frame bytes failed", len);
+    return false;
+  }
+  ESP_LOGV(TAG, "Ready after %u status reads in %" PRIu32 " us, read %u frame bytes", polls, micros() - start, len);
   return true;
 }
 
+bool PN532I2C::write_data_read_ack(const std::vector<uint8_t> &data, std::vector<uint8_t> &ack) {
+  // no stop after the command, so the first ACK read follows as a repeated start; if the PN532 has not finished
+  // with the frame by then read_data goes on polling
+  if (this->write(data.data(), data.size(), false) != i2c::ERROR_OK) {
+    return false;
+  }
+  return this->read_data(ack, 6);
+}
+
 bool PN532I2C::read_response(uint8_t command, std::vector<uint8_t> &data) {
   ESP_LOGV(TAG, "Reading response");
-  uint8_t len = this->read_response_length_();
+  if (!this->read_data(data, PN532_I2C_RESPONSE_FIRST_READ)) {
+    return false;
+  }
+  uint8_t len = this->response_length_(data);
   if (len == 0) {
     return false;
   }
 
-  ESP_LOGV(TAG, "Reading response of length %d", len);
-  if (!this->read_data(data, 6 + len + 2)) {
-    ESP_LOGD(TAG, "No response data");
-    return false;
+  // a response that did not fit into the first read is sent again after a NACK and read at its full length
+  if (6 + len + 2 > PN532_I2C_RESPONSE_FIRST_READ) {
+    ESP_LOGV(TAG, "Reading response of length %d", len);
+    this->send_nack_();
+    if (!this->read_data(data, 6 + len + 2)) {
+      ESP_LOGD(TAG, "No response data");
+      return false;
+    }
   }
+  data.resize(1 + 6 + len + 2);
 
   if (data[1] != 0x00 && data[2] != 0x00 && data[3] != 0xFF) {
     // invalid packet
@@ -89,12 +126,7 @@ bool PN532I2C::read_response(uint8_t command, std::vector<uint8_t> &data) {
   return true;
 }
 
-uint8_t PN532I2C::read_response_length_() {
-  std::vector<uint8_t> data;
-  if (!this->read_data(data, 6)) {
-    return 0;
-  }
-
+uint8_t PN532I2C::response_length_(const std::vector<uint8_t> &data) {
   if (data[1] != 0x00 && data[2] != 0x00 && data[3] != 0xFF) {
     // invalid packet
     ESP_LOGV(TAG, "read data invalid preamble!");
@@ -109,8 +141,6 @@ uint8_t PN532I2C::read_response_length_() {
     return 0;
   }
 
-  this->send_nack_();
-
   // full length of message, including TFI
   uint8_t full_len = data[4];
   // length of data, excluding TFI
@@ -16,9 +16,11 @@ class PN532I2C : public pn532::PN532, public i2c::I2CDevice {
  protected:
   bool is_read_ready() override;
   bool write_data(const std::vector<uint8_t> &data) override;
-  bool read_data(std::vector<uint8_t> &data, uint8_t len) override;
+  bool read_data(std::vector<uint8_t> &data, uint16_t len) override;
+  bool write_data_read_ack(const std::vector<uint8_t> &data, std::vector<uint8_t> &ack) override;
   bool read_response(uint8_t command, std::vector<uint8_t> &data) override;
-  uint8_t read_response_length_();
+  /// checks the frame header of a response read with read_data and returns the length of its data, 0 if invalid
+  uint8_t response_length_(const std::vector<uint8_t> &data);
 };
 
 }  // namespace pn532_i2c
@@ -0,0 +1,122 @@
+from esphome import automation, pins
+import esphome.codegen as cg
+from esphome.components import nfc
+import esphome.config_validation as cv
+from esphome.const import CONF_ON_TAG, CONF_ON_TAG_REMOVED, CONF_TRIGGER_ID
+
+AUTO_LOAD = ["binary_sensor", "nfc"]
+MULTI_CONF = True
+
+CONF_DISCOVERY_PERIOD = "discovery_period"
+CONF_DISCOVERY_PROTOCOLS = "discovery_protocols"
+CONF_DISCOVERY_TECHNOLOGIES = "discovery_technologies"
+CONF_IRQ_PIN = "irq_pin"
+CONF_TAG_TTL = "tag_ttl"
+CONF_VEN_PIN = "ven_pin"
+
+pn7150_ns = cg.esphome_ns.namespace("pn7150")
+PN7150 = pn7150_ns.class_("PN7150", nfc.Nfcc, cg.Component)
+
+# RF protocol -> (NCI protocol, NCI RF interface) for RF_DISCOVER_MAP_CMD
+DISCOVERY_PROTOCOLS = {
+    "t1t": (0x01, 0x01),
+    "t2t": (0x02, 0x01),
+    "t3t": (0x03, 0x01),
+    "iso_dep": (0x04, 0x02),
+}
+
+# RF technology -> NCI passive poll mode technology for RF_DISCOVER_CMD
+DISCOVERY_TECHNOLOGIES = {
+    "nfc_a": 0x00,
+    "nfc_b": 0x01,
+    "nfc_f": 0x02,
+    "iso15693": 0x06,
+}
+
+
+def validate_tag_ttl(config):
+    if config[CONF_TAG_TTL] <= config[CONF_DISCOVERY_PERIOD]:
+        raise cv.Invalid(
+            f"{CONF_TAG_TTL} must be longer than {CONF_DISCOVERY_PERIOD}, otherwise "
+            "tags still in the field are reported as removed between discovery cycles"
+        )
+    return config
+
+
+PN7150_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(PN7150),
+            cv.Required(CONF_IRQ_PIN): pins.gpio_input_pin_schema,
+            cv.Required(CONF_VEN_PIN): pins.gpio_output_pin_schema,
+            cv.Optional(CONF_DISCOVERY_PERIOD, default="300ms"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(
+                    min=cv.TimePeriod(milliseconds=50),
+                    max=cv.TimePeriod(milliseconds=65535),
+                ),
+            ),
+            cv.Optional(
+                CONF_DISCOVERY_PROTOCOLS, default=["t1t", "t2t", "t3t", "iso_dep"]
+            ): cv.ensure_list(cv.one_of(*DISCOVERY_PROTOCOLS, lower=True)),
+            cv.Optional(
+                CONF_DISCOVERY_TECHNOLOGIES, default=["nfc_a", "nfc_b", "nfc_f"]
+            ): cv.ensure_list(cv.one_of(*DISCOVERY_TECHNOLOGIES, lower=True)),
+            cv.Optional(
+                CONF_TAG_TTL, default="1000ms"
+            ): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_ON_TAG): automation.validate_automation(
+                {
+                    cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(nfc.NfcOnTagTrigger),
+                }
+            ),
+            cv.Optional(CONF_ON_TAG_REMOVED): automation.validate_automation(
+                {
+                    cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(nfc.NfcOnTagTrigger),
+                }
+            ),
+        }
+    ).extend(cv.COMPONENT_SCHEMA),
+    validate_tag_ttl,
+)
+
+
+def CONFIG_SCHEMA(conf):
+    if conf:
+        raise cv.Invalid(
+            "This component requires a transport, please use the pn7150_i2c platform"
+        )
+
+
+async def setup_pn7150(var, config):
+    await cg.register_component(var, config)
+
+    pin = await cg.gpio_pin_expression(config[CONF_IRQ_PIN])
+    cg.add(var.set_irq_pin(pin))
+
+    pin = await cg.gpio_pin_expression(config[CONF_VEN_PIN])
+    cg.add(var.set_ven_pin(pin))
+
+    cg.add(var.set_discovery_period(config[CONF_DISCOVERY_PERIOD]))
+    cg.add(var.set_tag_ttl(config[CONF_TAG_TTL]))
+
+    for protocol in config[CONF_DISCOVERY_PROTOCOLS]:
+        nci_protocol, nci_interface = DISCOVERY_PROTOCOLS[protocol]
+        cg.add(var.add_discover_map_entry(nci_protocol, nci_interface))
+
+    for technology in config[CONF_DISCOVERY_TECHNOLOGIES]:
+        cg.add(var.add_discovery_technology(DISCOVERY_TECHNOLOGIES[technology]))
+
+    for conf in config.get(CONF_ON_TAG, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID])
+        cg.add(var.register_ontag_trigger(trigger))
+        await automation.build_automation(
+            trigger, [(cg.std_string, "x"), (nfc.NfcTag, "tag")], conf
+        )
+
+    for conf in config.get(CONF_ON_TAG_REMOVED, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID])
+        cg.add(var.register_ontagremoved_trigger(trigger))
+        await automation.build_automation(
+            trigger, [(cg.std_string, "x"), (nfc.NfcTag, "tag")], conf
+        )
@@ -0,0 +1,702 @@
+#include "pn7150.h"
+
+#include <algorithm>
+#include <memory>
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+// Based on:
+// - https://www.nxp.com/docs/en/data-sheet/PN7150.pdf
+// - https://www.nxp.com/docs/en/user-guide/UM10936.pdf
+// - NFC Forum NCI Technical Specification 1.0/2.0
+
+namespace esphome {
+namespace pn7150 {
+
+static const char *const TAG = "pn7150";
+
+void PN7150::setup() {
+  ESP_LOGCONFIG(TAG, "Running setup");
+
+  this->irq_pin_->setup();
+  this->ven_pin_->setup();
+
+  if (!this->init_nfcc_()) {
+    ESP_LOGW(TAG, "NFCC initialization failed; will retry");
+  }
+}
+
+void PN7150::dump_config() {
+  ESP_LOGCONFIG(TAG, "PN7150:");
+  ESP_LOGCONFIG(TAG, "  NCI version: %u.%u", this->nci_version_ >> 4, this->nci_version_ & 0x0F);
+  ESP_LOGCONFIG(TAG, "  Discovery period: %u ms", this->discovery_period_);
+  ESP_LOGCONFIG(TAG, "  Tag TTL: %" PRIu32 " ms", this->tag_ttl_);
+  LOG_PIN("  IRQ pin: ", this->irq_pin_);
+  LOG_PIN("  VEN pin: ", this->ven_pin_);
+}
+
+void PN7150::loop() {
+  if (this->nci_state_error_ != NCIState::NONE) {
+    // re-run the init sequence, but don't hammer the bus doing it
+    if (millis() - this->last_nci_state_change_ > NFCC_INIT_TIMEOUT * 20) {
+      this->init_nfcc_();
+    }
+    return;
+  }
+
+  this->purge_old_tags_();
+
+  // the NFCC runs the RF discovery loop on its own; it raises IRQ only when it has something for us
+  if (this->irq_pin_->digital_read()) {
+    this->process_message_();
+  }
+}
+
+bool PN7150::init_nfcc_() {
+  this->nci_fsm_set_state_(NCIState::NFCC_RESET);
+  if (this->reset_core_(true, true) != nfc::STATUS_OK) {
+    ESP_LOGE(TAG, "Failed to reset NCI core");
+    this->nci_fsm_set_error_state_(NCIState::NFCC_RESET);
+    return false;
+  }
+
+  this->nci_fsm_set_state_(NCIState::NFCC_INIT);
+  if (this->init_core_() != nfc::STATUS_OK) {
+    ESP_LOGE(TAG, "Failed to initialise NCI core");
+    this->nci_fsm_set_error_state_(NCIState::NFCC_INIT);
+    return false;
+  }
+
+  this->nci_fsm_set_state_(NCIState::NFCC_CONFIG);
+  if (this->send_core_config_() != nfc::STATUS_OK) {
+    ESP_LOGE(TAG, "Failed to send core config");
+    this->nci_fsm_set_error_state_(NCIState::NFCC_CONFIG);
+    return false;
+  }
+
+  this->nci_fsm_set_state_(NCIState::NFCC_SET_DISCOVER_MAP);
+  if (this->set_discover_map_() != nfc::STATUS_OK) {
+    ESP_LOGE(TAG, "Failed to set discover map");
+    this->nci_fsm_set_error_state_(NCIState::NFCC_SET_DISCOVER_MAP);
+    return false;
+  }
+
+  this->nci_fsm_set_state_(NCIState::RFST_IDLE);
+  if (this->start_discovery_() != nfc::STATUS_OK) {
+    ESP_LOGE(TAG, "Failed to start discovery");
+    this->nci_fsm_set_error_state_(NCIState::RFST_IDLE);
+    return false;
+  }
+
+  this->nci_state_error_ = NCIState::NONE;
+  this->error_count_ = 0;
+  return true;
+}
+
+uint8_t PN7150::reset_core_(const bool reset_config, const bool power) {
+  if (power) {
+    this->ven_pin_->digital_write(true);
+    delay(NFCC_DEFAULT_TIMEOUT);
+    this->ven_pin_->digital_write(false);
+    delay(NFCC_DEFAULT_TIMEOUT);
+    this->ven_pin_->digital_write(true);
+    delay(NFCC_INIT_TIMEOUT);
+  }
+
+  nfc::NciMessage rx;
+  nfc::NciMessage tx(nfc::NCI_PKT_MT_CTRL_COMMAND, nfc::NCI_CORE_GID, nfc::NCI_CORE_RESET_OID,
+                     {(uint8_t) reset_config});
+
+  if (this->transceive_(tx, rx, NFCC_INIT_TIMEOUT) != nfc::STATUS_OK) {
+    ESP_LOGE(TAG, "Error sending reset command");
+    return nfc::STATUS_FAILED;
+  }
+
+  if (rx.message_length_is(3)) {
+    // NCI 1.0 (PN7150): status, NCI version, configuration status
+    this->nci_version_ = rx.get_message_byte(nfc::NCI_PKT_PAYLOAD_OFFSET + 1);
+  } else {
+    // NCI 2.0 (PN7160): the version comes with the CORE_RESET_NTF that follows the response
+    if (this->read_nfcc(rx, NFCC_INIT_TIMEOUT) != nfc::STATUS_OK) {
+      ESP_LOGE(TAG, "No reset notification received");
+      return nfc::STATUS_FAILED;
+    }
+    if (!rx.message_type_is(nfc::NCI_PKT_MT_CTRL_NOTIFICATION) || !rx.gid_is(nfc::NCI_CORE_GID) ||
+        !rx.oid_is(nfc::NCI_CORE_RESET_OID)) {
+      ESP_LOGE(TAG, "Invalid reset notification: %s", nfc::format_bytes(rx.data(), rx.size()).c_str());
+      return nfc::STATUS_FAILED;
+    }
+    // reset trigger, configuration status, NCI version
+    this->nci_version_ = rx.get_message_byte(nfc::NCI_PKT_PAYLOAD_OFFSET + 2);
+  }
+
+  if ((this->nci_version_ & 0xF0) != NCI_VERSION_1_0 && (this->nci_version_ & 0xF0) != NCI_VERSION_2_0) {
+    ESP_LOGE(TAG, "Unsupported NCI version 0x%02X", this->nci_version_);
+    return nfc::STATUS_FAILED;
+  }
+
+  ESP_LOGD(TAG, "Configuration %s, NCI version %u.%u", reset_config ? "reset" : "retained", this->nci_version_ >> 4,
+           this->nci_version_ & 0x0F);
+  return nfc::STATUS_OK;
+}
+
+uint8_t PN7150::init_core_() {
+  nfc::NciMessage rx;
+  nfc::NciMessage tx(nfc::NCI_PKT_MT_CTRL_COMMAND, nfc::NCI_CORE_GID, nfc::NCI_CORE_INIT_OID);
+  if ((this->nci_version_ & 0xF0) == NCI_VERSION_2_0) {
+    tx.set_payload({0x00, 0x00});  // no NCI 2.0 features requested
+  }
+
+  if (this->transceive_(tx, rx, NFCC_INIT_TIMEOUT) != nfc::STATUS_OK) {
+    ESP_LOGE(TAG, "Error sending initialise command");
+    return nfc::STATUS_FAILED;
+  }
+
+  if ((this->nci_version_ & 0xF0) == NCI_VERSION_1_0) {
+    // manufacturer-specific information follows the list of supported RF interfaces
+    uint8_t num_intf = rx.get_message_byte(8);
+    ESP_LOGD(TAG, "Hardware version: %u, ROM code version: %u, FLASH version: %u.%u",
+             rx.get_message_byte(17 + num_intf), rx.get_message_byte(18 + num_intf),
+             rx.get_message_byte(19 + num_intf), rx.get_message_byte(20 + num_intf));
+  }
+  return nfc::STATUS_OK;
+}
+
+uint8_t PN7150::send_core_config_() {
+  // TOTAL_DURATION is the length of one full discovery cycle; the NFCC idles between polls on its own
+  nfc::NciMessage rx;
+  nfc::NciMessage tx(nfc::NCI_PKT_MT_CTRL_COMMAND, nfc::NCI_CORE_GID, nfc::NCI_CORE_SET_CONFIG_OID,
+                     {0x01, CONFIG_TOTAL_DURATION, 0x02, (uint8_t) (this->discovery_period_ & 0xFF),
+                      (uint8_t) (this->discovery_period_ >> 8)});
+
+  if (this->transceive_(tx, rx) != nfc::STATUS_OK) {
+    ESP_LOGE(TAG, "Error sending core config");
+    return nfc::STATUS_FAILED;
+  }
+  return nfc::STATUS_OK;
+}
+
+uint8_t PN7150::set_discover_map_() {
+  nfc::NciMessage rx;
+  nfc::NciMessage tx(nfc::NCI_PKT_MT_CTRL_COMMAND, nfc::RF_GID, nfc::RF_DISCOVER_MAP_OID);
+  uint8_t *payload = tx.payload();
+  payload[0] = this->discover_map_.size() / 3;
+  std::copy(this->discover_map_.begin(), this->discover_map_.end(), payload + 1);
+  tx.set_payload_size(this->discover_map_.size() + 1);
+
+  if (this->transceive_(tx, rx) != nfc::STATUS_OK) {
+    ESP_LOGE(TAG, "Error sending discover map");
+    return nfc::STATUS_FAILED;
+  }
+  return nfc::STATUS_OK;
+}
+
+uint8_t PN7150::start_discovery_() {
+  nfc::NciMessage rx;
+  nfc::NciMessage tx(nfc::NCI_PKT_MT_CTRL_COMMAND, nfc::RF_GID, nfc::RF_DISCOVER_OID);
+  uint8_t *payload = tx.payload();
+  uint8_t length = 0;
+  payload[length++] = this->discovery_techs_.size();
+  for (auto tech : this->discovery_techs_) {
+    payload[length++] = nfc::MODE_POLL | tech;
+    payload[length++] = 0x01;  // poll in every discovery period
+  }
+  tx.set_payload_size(length);
+
+  if (this->transceive_(tx, rx) != nfc::STATUS_OK) {
+    ESP_LOGE(TAG, "Error starting discovery");
+    return nfc::STATUS_FAILED;
+  }
+
+  this->nci_fsm_set_state_(NCIState::RFST_DISCOVERY);
+  return nfc::STATUS_OK;
+}
+
+uint8_t PN7150::deactivate_(const uint8_t type, const uint16_t timeout) {
+  nfc::NciMessage rx;
+  nfc::NciMessage tx(nfc::NCI_PKT_MT_CTRL_COMMAND, nfc::RF_GID, nfc::RF_DEACTIVATE_OID, {type});
+
+  this->nci_fsm_set_state_(NCIState::EP_DEACTIVATING);
+  if (this->transceive_(tx, rx, timeout) != nfc::STATUS_OK) {
+    ESP_LOGE(TAG, "Error sending deactivate command");
+    return nfc::STATUS_FAILED;
+  }
+
+  // a successful response is always followed by RF_DEACTIVATE_NTF
+  if (this->read_nfcc(rx, timeout) != nfc::STATUS_OK) {
+    ESP_LOGE(TAG, "No deactivate notification received");
+    return nfc::STATUS_FAILED;
+  }
+  if (!rx.message_type_is(nfc::NCI_PKT_MT_CTRL_NOTIFICATION) || !rx.gid_is(nfc::RF_GID) ||
+      !rx.oid_is(nfc::RF_DEACTIVATE_OID)) {
+    ESP_LOGE(TAG, "Invalid deactivate notification: %s", nfc::format_bytes(rx.data(), rx.size()).c_str());
+    return nfc::STATUS_FAILED;
+  }
+
+  this->process_rf_deactivate_oid_(rx);
+  return nfc::STATUS_OK;
+}
+
+void PN7150::select_endpoint_() {
+  uint8_t interface = nfc::INTF_FRAME;
+  for (size_t i = 0; i + 2 < this->discover_map_.size(); i += 3) {
+    if (this->discover_map_[i] == this->selecting_protocol_) {
+      interface = this->discover_map_[i + 2];
+      break;
+    }
+  }
+
+  nfc::NciMessage rx;
+  nfc::NciMessage tx(nfc::NCI_PKT_MT_CTRL_COMMAND, nfc::RF_GID, nfc::RF_DISCOVER_SELECT_OID,
+                     {this->selecting_endpoint_, this->selecting_protocol_, interface});
+
+  this->nci_fsm_set_state_(NCIState::EP_SELECTING);
+  if (this->transceive_(tx, rx) != nfc::STATUS_OK) {
+    ESP_LOGE(TAG, "Error selecting endpoint");
+    if (this->deactivate_(nfc::DEACTIVATION_TYPE_DISCOVERY) != nfc::STATUS_OK) {
+      this->nci_fsm_set_error_state_(NCIState::EP_SELECTING);
+    }
+  }
+  // the activation itself is reported later via RF_INTF_ACTIVATED_NTF
+}
+
+void PN7150::process_message_() {
+  nfc::NciMessage rx;
+  if (this->read_nfcc(rx, NFCC_DEFAULT_TIMEOUT) != nfc::STATUS_OK) {
+    return;  // No data
+  }
+
+  switch (rx.get_message_type()) {
+    case nfc::NCI_PKT_MT_CTRL_NOTIFICATION:
+      if (rx.gid_is(nfc::RF_GID)) {
+        switch (rx.get_oid()) {
+          case nfc::RF_INTF_ACTIVATED_OID:
+            ESP_LOGVV(TAG, "RF_INTF_ACTIVATED_OID");
+            this->process_rf_intf_activated_oid_(rx);
+            return;
+
+          case nfc::RF_DISCOVER_OID:
+            ESP_LOGVV(TAG, "RF_DISCOVER_OID");
+            this->process_rf_discover_oid_(rx);
+            return;
+
+          case nfc::RF_DEACTIVATE_OID:
+            ESP_LOGVV(TAG, "RF_DEACTIVATE_OID: type: 0x%02X, reason: 0x%02X",
+                      rx.get_message_byte(nfc::NCI_PKT_PAYLOAD_OFFSET),
+                      rx.get_message_byte(nfc::NCI_PKT_PAYLOAD_OFFSET + 1));
+            this->process_rf_deactivate_oid_(rx);
+            return;
+
+          default:
+            ESP_LOGV(TAG, "Unimplemented RF OID received: 0x%02X", rx.get_oid());
+        }
+      } else if (rx.gid_is(nfc::NCI_CORE_GID)) {
+        switch (rx.get_oid()) {
+          case nfc::NCI_CORE_GENERIC_ERROR_OID:
+            ESP_LOGV(TAG, "NCI_CORE_GENERIC_ERROR_OID:");
+            switch (rx.get_simple_status_response()) {
+              case nfc::DISCOVERY_ALREADY_STARTED:
+                ESP_LOGV(TAG, "  DISCOVERY_ALREADY_STARTED");
+                break;
+
+              case nfc::DISCOVERY_TARGET_ACTIVATION_FAILED:
+                // the NFCC restarts discovery on its own
+                ESP_LOGV(TAG, "  DISCOVERY_TARGET_ACTIVATION_FAILED");
+                break;
+
+              case nfc::DISCOVERY_TEAR_DOWN:
+                ESP_LOGV(TAG, "  DISCOVERY_TEAR_DOWN");
+                break;
+
+              default:
+                ESP_LOGW(TAG, "Unknown error: 0x%02X", rx.get_simple_status_response());
+                break;
+            }
+            return;
+
+          case nfc::NCI_CORE_INTERFACE_ERROR_OID:
+            ESP_LOGW(TAG, "NCI_CORE_INTERFACE_ERROR_OID: 0x%02X", rx.get_simple_status_response());
+            return;
+
+          case nfc::NCI_CORE_CONN_CREDITS_OID:
+            this->process_conn_credits_(rx);
+            return;
+
+          default:
+            ESP_LOGV(TAG, "Unimplemented NCI Core OID received: 0x%02X", rx.get_oid());
+        }
+      } else {
+        ESP_LOGV(TAG, "Unimplemented notification: %s", nfc::format_bytes(rx.data(), rx.size()).c_str());
+      }
+      break;
+
+    case nfc::NCI_PKT_MT_CTRL_RESPONSE:
+      ESP_LOGV(TAG, "Unimplemented GID: 0x%02X  OID: 0x%02X  Full response: %s", rx.get_gid(), rx.get_oid(),
+               nfc::format_bytes(rx.data(), rx.size()).c_str());
+      break;
+
+    case nfc::NCI_PKT_MT_CTRL_COMMAND:
+      ESP_LOGV(TAG, "Unimplemented command: %s", nfc::format_bytes(rx.data(), rx.size()).c_str());
+      break;
+
+    case nfc::NCI_PKT_MT_DATA:
+      ESP_LOGV(TAG, "Unexpected data message: %s", nfc::format_bytes(rx.data(), rx.size()).c_str());
+      break;
+
+    default:
+      ESP_LOGV(TAG, "Unknown message type received: %s", nfc::format_bytes(rx.data(), rx.size()).c_str());
+      break;
+  }
+}
+
+void PN7150::process_rf_intf_activated_oid_(nfc::NciMessage &rx) {
+  uint8_t discovery_id = rx.get_message_byte(nfc::RF_INTF_ACTIVATED_NTF_DISCOVERY_ID);
+  uint8_t interface = rx.get_message_byte(nfc::RF_INTF_ACTIVATED_NTF_INTERFACE);
+  uint8_t protocol = rx.get_message_byte(nfc::RF_INTF_ACTIVATED_NTF_PROTOCOL);
+  uint8_t mode_tech = rx.get_message_byte(nfc::RF_INTF_ACTIVATED_NTF_MODE_TECH);
+  this->max_payload_size_ = rx.get_message_byte(nfc::RF_INTF_ACTIVATED_NTF_MAX_SIZE);
+  this->initial_credits_ = rx.get_message_byte(nfc::RF_INTF_ACTIVATED_NTF_INIT_CRED);
+  this->credits_ = this->initial_credits_;
+
+  ESP_LOGVV(TAG, "Endpoint %u activated: interface 0x%02X, protocol 0x%02X, mode/tech 0x%02X", discovery_id,
+            interface, protocol, mode_tech);
+  this->nci_fsm_set_state_(NCIState::RFST_POLL_ACTIVE);
+
+  auto incoming_tag = this->build_tag_(mode_tech, rx);
+  if (incoming_tag == nullptr) {
+    ESP_LOGE(TAG, "Could not build tag");
+  } else {
+    auto tag_loc = this->find_tag_uid_(incoming_tag->get_uid());
+    if (tag_loc.has_value()) {
+      // already reported; the tag is still in the field
+      this->discovered_endpoint_[tag_loc.value()].id = discovery_id;
+      this->discovered_endpoint_[tag_loc.value()].last_seen = millis();
+    } else {
+      if (this->read_endpoint_data_(protocol, *incoming_tag) != nfc::STATUS_OK) {
+        ESP_LOGW(TAG, "Unable to read tag data");
+      }
+
+      ESP_LOGD(TAG, "Found new tag '%s'", nfc::format_uid(incoming_tag->get_uid()).c_str());
+      if (incoming_tag->has_ndef_message()) {
+        const auto &message = incoming_tag->get_ndef_message();
+        const auto &records = message->get_records();
+        ESP_LOGD(TAG, "  NDEF formatted records:");
+        for (const auto &record : records) {
+          ESP_LOGD(TAG, "    %s - %s", record->get_type().c_str(), record->get_payload().c_str());
+        }
+      }
+
+      for (auto *listener : this->tag_listeners_)
+        listener->tag_on(*incoming_tag);
+      for (auto *trigger : this->triggers_ontag_)
+        trigger->process(incoming_tag);
+
+      this->discovered_endpoint_.push_back({discovery_id, protocol, millis(), std::move(incoming_tag)});
+    }
+  }
+
+  // hand the RF loop back to the NFCC; it will re-activate the tag on a later cycle if it is still present
+  if (this->deactivate_(nfc::DEACTIVATION_TYPE_DISCOVERY) != nfc::STATUS_OK) {
+    this->nci_fsm_set_error_state_(NCIState::EP_DEACTIVATING);
+  }
+}
+
+void PN7150::process_rf_discover_oid_(nfc::NciMessage &rx) {
+  // several endpoints were found; the NFCC waits for us to pick one once the last notification arrives
+  if (this->nci_state_ != NCIState::RFST_W4_ALL_DISCOVERIES) {
+    this->selecting_endpoint_ = rx.get_message_byte(nfc::RF_DISCOVER_NTF_DISCOVERY_ID);
+    this->selecting_protocol_ = rx.get_message_byte(nfc::RF_DISCOVER_NTF_PROTOCOL);
+    this->nci_fsm_set_state_(NCIState::RFST_W4_ALL_DISCOVERIES);
+  }
+
+  uint8_t notification_type = rx.get_message_byte(rx.size() - 1);
+  if (notification_type != nfc::RF_DISCOVER_NTF_NT_MORE) {
+    this->nci_fsm_set_state_(NCIState::RFST_W4_HOST_SELECT);
+    this->select_endpoint_();
+  }
+}
+
+void PN7150::process_rf_deactivate_oid_(nfc::NciMessage &rx) {
+  switch (rx.get_message_byte(nfc::NCI_PKT_PAYLOAD_OFFSET)) {
+    case nfc::DEACTIVATION_TYPE_DISCOVERY:
+      this->nci_fsm_set_state_(NCIState::RFST_DISCOVERY);
+      break;
+
+    case nfc::DEACTIVATION_TYPE_IDLE:
+      this->nci_fsm_set_state_(NCIState::RFST_IDLE);
+      break;
+
+    case nfc::DEACTIVATION_TYPE_SLEEP:
+    case nfc::DEACTIVATION_TYPE_SLEEP_AF:
+      this->nci_fsm_set_state_(NCIState::RFST_W4_HOST_SELECT);
+      break;
+
+    default:
+      break;
+  }
+}
+
+uint8_t PN7150::read_endpoint_data_(const uint8_t protocol, nfc::NfcTag &tag) {
+  switch (protocol) {
+    case nfc::PROT_T2T:
+      ESP_LOGD(TAG, "Mifare ultralight");
+      return this->read_mifare_ultralight_tag_(tag);
+
+    default:
+      ESP_LOGV(TAG, "No NDEF reader for protocol 0x%02X", protocol);
+      return nfc::STATUS_OK;
+  }
+}
+
+std::unique_ptr<nfc::NfcTag> PN7150::build_tag_(const uint8_t mode_tech, const nfc::NciMessage &rx) {
+  const uint8_t params = nfc::RF_INTF_ACTIVATED_NTF_RF_TECH_PARAMS;
+  const uint8_t params_length = rx.get_message_byte(nfc::RF_INTF_ACTIVATED_NTF_RF_TECH_LENGTH);
+  const uint8_t protocol = rx.get_message_byte(nfc::RF_INTF_ACTIVATED_NTF_PROTOCOL);
+  uint8_t uid_offset = 0;
+  uint8_t uid_length = 0;
+
+  switch (mode_tech) {
+    case (nfc::MODE_POLL | nfc::TECH_PASSIVE_NFCA):
+      // SENS_RES (2), NFCID1 length (1), NFCID1, SEL_RES length (1), SEL_RES
+      if (params_length > NFCA_NFCID1_LENGTH_OFFSET) {
+        uid_offset = params + NFCA_NFCID1_OFFSET;
+        uid_length = rx.get_message_byte(params + NFCA_NFCID1_LENGTH_OFFSET);
+      }
+      break;
+
+    case (nfc::MODE_POLL | nfc::TECH_PASSIVE_NFCB):
+      // SENSB_RES length (1), SENSB_RES (starting at NFCID0)
+      uid_offset = params + 1;
+      uid_length = 4;
+      break;
+
+    case (nfc::MODE_POLL | nfc::TECH_PASSIVE_NFCF):
+      // bit rate (1), SENSF_RES length (1), SENSF_RES (starting at NFCID2)
+      uid_offset = params + 2;
+      uid_length = 8;
+      break;
+
+    default:
+      ESP_LOGE(TAG, "Unsupported mode/technology: 0x%02X", mode_tech);
+      return nullptr;
+  }
+
+  if (uid_length == 0 || uid_offset + uid_length > rx.size() || uid_offset + uid_length > params + params_length) {
+    ESP_LOGE(TAG, "Invalid technology parameters: %s", nfc::format_bytes(rx.data(), rx.size()).c_str());
+    return nullptr;
+  }
+
+  std::vector<uint8_t> uid(rx.data() + uid_offset, rx.data() + uid_offset + uid_length);
+  switch (protocol) {
+    case nfc::PROT_T2T:
+      return make_unique<nfc::NfcTag>(uid, nfc::NFC_FORUM_TYPE_2);
+    case nfc::PROT_MIFARE:
+      return make_unique<nfc::NfcTag>(uid, nfc::MIFARE_CLASSIC);
+    default:
+      return make_unique<nfc::NfcTag>(uid);
+  }
+}
+
+optional<size_t> PN7150::find_tag_uid_(const std::vector<uint8_t> &uid) {
+  for (size_t i = 0; i < this->discovered_endpoint_.size(); i++) {
+    if (this->discovered_endpoint_[i].tag->get_uid() == uid) {
+      return i;
+    }
+  }
+  return nullopt;
+}
+
+void PN7150::purge_old_tags_() {
+  for (size_t i = 0; i < this->discovered_endpoint_.size(); i++) {
+    if (millis() - this->discovered_endpoint_[i].last_seen > this->tag_ttl_) {
+      this->erase_tag_(i);
+      i--;
+    }
+  }
+}
+
+void PN7150::erase_tag_(const uint8_t tag_index) {
+  if (tag_index < this->discovered_endpoint_.size()) {
+    auto &tag = this->discovered_endpoint_[tag_index].tag;
+    ESP_LOGD(TAG, "Tag %s removed", nfc::format_uid(tag->get_uid()).c_str());
+    for (auto *listener : this->tag_listeners_)
+      listener->tag_off(*tag);
+    for (auto *trigger : this->triggers_ontagremoved_)
+      trigger->process(tag);
+    this->discovered_endpoint_.erase(this->discovered_endpoint_.begin() + tag_index);
+  }
+}
+
+void PN7150::nci_fsm_set_state_(NCIState new_state) {
+  ESP_LOGVV(TAG, "nci_fsm_set_state_(%u)", (uint8_t) new_state);
+  this->nci_state_ = new_state;
+  this->last_nci_state_change_ = millis();
+}
+
+bool PN7150::nci_fsm_set_error_state_(NCIState new_state) {
+  ESP_LOGVV(TAG, "nci_fsm_set_error_state_(%u); error_count_ = %u", (uint8_t) new_state, this->error_count_);
+  this->nci_state_error_ = new_state;
+  this->last_nci_state_change_ = millis();
+  if (this->error_count_++ > NFCC_MAX_ERROR_COUNT) {
+    if ((this->nci_state_error_ == NCIState::NFCC_RESET) || (this->nci_state_error_ == NCIState::NFCC_INIT) ||
+        (this->nci_state_error_ == NCIState::NFCC_CONFIG) ||
+        (this->nci_state_error_ == NCIState::NFCC_SET_DISCOVER_MAP)) {
+      ESP_LOGE(TAG, "Too many initialization failures -- check device connections");
+      this->mark_failed();
+      this->nci_fsm_set_state_(NCIState::FAILED);
+    } else {
+      ESP_LOGW(TAG, "Too many errors transitioning to state %u; resetting NFCC", (uint8_t) this->nci_state_error_);
+      this->nci_fsm_set_state_(NCIState::NFCC_RESET);
+    }
+    this->error_count_ = 0;
+    return true;
+  }
+  return false;
+}
+
+uint8_t PN7150::transceive_(nfc::NciMessage &tx, nfc::NciMessage &rx, const uint16_t timeout) {
+  uint8_t retries = NFCC_MAX_COMM_FAILS;
+
+  while (true) {
+    // first, send the message we need to send
+    if (this->write_nfcc(tx) != nfc::STATUS_OK) {
+      ESP_LOGE(TAG, "Error sending message");
+      return nfc::STATUS_FAILED;
+    }
+    ESP_LOGVV(TAG, "Wrote: %s", nfc::format_bytes(tx.data(), tx.size()).c_str());
+    // next, the NFCC should send back a response
+    if (this->read_nfcc(rx, timeout) == nfc::STATUS_OK) {
+      break;
+    }
+    ESP_LOGW(TAG, "Error receiving message");
+    if (!retries--) {
+      ESP_LOGE(TAG, "  ...giving up");
+      return nfc::STATUS_FAILED;
+    }
+  }
+  ESP_LOGVV(TAG, "Read: %s", nfc::format_bytes(rx.data(), rx.size()).c_str());
+
+  // the GID and OID should match and the status should be OK
+  if ((rx.get_gid() != tx.get_gid()) || (rx.get_oid()) != tx.get_oid()) {
+    ESP_LOGE(TAG, "Incorrect response to command: %s", nfc::format_bytes(rx.data(), rx.size()).c_str());
+    return nfc::STATUS_FAILED;
+  }
+
+  if (!rx.simple_status_response_is(nfc::STATUS_OK)) {
+    ESP_LOGE(TAG, "Error in response to command: %s", nfc::format_bytes(rx.data(), rx.size()).c_str());
+  }
+  return rx.get_simple_status_response();
+}
+
+uint8_t PN7150::exchange_data_(const uint8_t *tx_data, const size_t tx_len, std::vector<uint8_t> &rx_data,
+                               const uint16_t timeout) {
+  if (this->write_data_(tx_data, tx_len, timeout) != nfc::STATUS_OK) {
+    return nfc::STATUS_FAILED;
+  }
+  return this->read_data_(rx_data, timeout);
+}
+
+uint8_t PN7150::write_data_(const uint8_t *data, const size_t len, const uint16_t timeout) {
+  // the NFCC told us how large a data packet it accepts when the interface was activated
+  const size_t max_segment = this->max_payload_size_ ? this->max_payload_size_ : nfc::NCI_MAX_PAYLOAD_SIZE;
+  nfc::NciMessage tx;
+  size_t offset = 0;
+
+  do {
+    if ((this->credits_ == 0) && (this->wait_for_credits_(timeout) != nfc::STATUS_OK)) {
+      ESP_LOGE(TAG, "No credit returned for data segment at offset %zu", offset);
+      return nfc::STATUS_FAILED;
+    }
+    const size_t segment = std::min(len - offset, max_segment);
+    tx.set_header(nfc::NCI_PKT_MT_DATA, STATIC_RF_CONN_ID, 0x00);
+    tx.set_pbf(offset + segment < len);
+    tx.set_payload(data + offset, segment);
+
+    if (this->write_nfcc(tx) != nfc::STATUS_OK) {
+      ESP_LOGE(TAG, "Error sending data segment");
+      return nfc::STATUS_FAILED;
+    }
+    ESP_LOGVV(TAG, "Wrote: %s", nfc::format_bytes(tx.data(), tx.size()).c_str());
+
+    if (this->credits_ != nfc::NCI_CONN_CREDITS_FLOW_CONTROL_DISABLED) {
+      this->credits_--;
+    }
+    offset += segment;
+  } while (offset < len);
+
+  return nfc::STATUS_OK;
+}
+
+uint8_t PN7150::read_data_(std::vector<uint8_t> &data, const uint16_t timeout) {
+  nfc::NciMessage rx;
+
+  while (true) {
+    if (this->read_nfcc(rx, timeout) != nfc::STATUS_OK) {
+      ESP_LOGE(TAG, "Error receiving data from endpoint");
+      return nfc::STATUS_FAILED;
+    }
+    ESP_LOGVV(TAG, "Read: %s", nfc::format_bytes(rx.data(), rx.size()).c_str());
+
+    if (rx.message_type_is(nfc::NCI_PKT_MT_DATA) && rx.gid_is(STATIC_RF_CONN_ID)) {
+      // segments are appended as they arrive; the last one has the PBF bit clear
+      data.insert(data.end(), rx.payload(), rx.payload() + rx.get_payload_size());
+      if (!rx.pbf_is_set()) {
+        return nfc::STATUS_OK;
+      }
+    } else if (!this->process_conn_credits_(rx)) {
+      ESP_LOGE(TAG, "Unexpected message while receiving data: %s", nfc::format_bytes(rx.data(), rx.size()).c_str());
+      return nfc::STATUS_FAILED;
+    }
+  }
+}
+
+uint8_t PN7150::wait_for_credits_(const uint16_t timeout) {
+  nfc::NciMessage rx;
+
+  while (this->credits_ == 0) {
+    if (this->read_nfcc(rx, timeout) != nfc::STATUS_OK) {
+      return nfc::STATUS_FAILED;
+    }
+    ESP_LOGVV(TAG, "Read: %s", nfc::format_bytes(rx.data(), rx.size()).c_str());
+    if (!this->process_conn_credits_(rx)) {
+      ESP_LOGE(TAG, "Unexpected message while waiting for credits: %s",
+               nfc::format_bytes(rx.data(), rx.size()).c_str());
+      return nfc::STATUS_FAILED;
+    }
+  }
+  return nfc::STATUS_OK;
+}
+
+bool PN7150::process_conn_credits_(const nfc::NciMessage &rx) {
+  if (!rx.message_type_is(nfc::NCI_PKT_MT_CTRL_NOTIFICATION) || !rx.gid_is(nfc::NCI_CORE_GID) ||
+      !rx.oid_is(nfc::NCI_CORE_CONN_CREDITS_OID)) {
+    return false;
+  }
+  // one (connection ID, credits) pair follows for each connection
+  const uint8_t entries = rx.get_message_byte(nfc::CORE_CONN_CREDITS_NTF_NUM_ENTRIES);
+  for (uint8_t i = 0; i < entries; i++) {
+    const uint16_t entry = nfc::CORE_CONN_CREDITS_NTF_ENTRIES + i * 2;
+    if ((rx.get_message_byte(entry) == STATIC_RF_CONN_ID) &&
+        (this->credits_ != nfc::NCI_CONN_CREDITS_FLOW_CONTROL_DISABLED)) {
+      this->credits_ = std::min<uint16_t>(this->credits_ + rx.get_message_byte(entry + 1),
+                                          nfc::NCI_CONN_CREDITS_FLOW_CONTROL_DISABLED - 1);
+    }
+  }
+  return true;
+}
+
+uint8_t PN7150::wait_for_irq_(const uint16_t timeout, const bool pin_state) {
+  auto start_time = millis();
+
+  while (millis() - start_time < timeout) {
+    if (this->irq_pin_->digital_read() == pin_state) {
+      return nfc::STATUS_OK;
+    }
+    yield();
+  }
+  ESP_LOGW(TAG, "Timed out waiting for IRQ state");
+  return nfc::STATUS_FAILED;
+}
+
+}  // namespace pn7150
+}  // namespace esphome
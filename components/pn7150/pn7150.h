@@ -0,0 +1,158 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/core/automation.h"
+#include "esphome/core/gpio.h"
+#include "esphome/components/nfc/nci_core.h"
+#include "esphome/components/nfc/nci_message.h"
+#include "esphome/components/nfc/nfc_tag.h"
+#include "esphome/components/nfc/nfc.h"
+#include "esphome/components/nfc/automation.h"
+
+#include <cinttypes>
+#include <vector>
+
+namespace esphome {
+namespace pn7150 {
+
+static const uint16_t NFCC_DEFAULT_TIMEOUT = 10;
+static const uint16_t NFCC_INIT_TIMEOUT = 50;
+static const uint8_t NFCC_MAX_COMM_FAILS = 3;
+static const uint8_t NFCC_MAX_ERROR_COUNT = 10;
+
+static const uint8_t NCI_VERSION_1_0 = 0x10;
+static const uint8_t NCI_VERSION_2_0 = 0x20;
+
+static const uint8_t STATIC_RF_CONN_ID = 0x00;
+
+// CORE_SET_CONFIG parameter tags
+static const uint8_t CONFIG_TOTAL_DURATION = 0x00;
+
+// RF_INTF_ACTIVATED_NTF, NFC-A poll mode technology specific parameter offsets (relative to RF_TECH_PARAMS)
+static const uint8_t NFCA_NFCID1_LENGTH_OFFSET = 2;
+static const uint8_t NFCA_NFCID1_OFFSET = 3;
+
+enum class NCIState : uint8_t {
+  NONE = 0x00,
+  NFCC_RESET,
+  NFCC_INIT,
+  NFCC_CONFIG,
+  NFCC_SET_DISCOVER_MAP,
+  RFST_IDLE,
+  RFST_DISCOVERY,
+  RFST_W4_ALL_DISCOVERIES,
+  RFST_W4_HOST_SELECT,
+  RFST_POLL_ACTIVE,
+  EP_DEACTIVATING,
+  EP_SELECTING,
+  FAILED = 0xFF,
+};
+
+struct DiscoveredEndpoint {
+  uint8_t id;
+  uint8_t protocol;
+  uint32_t last_seen;
+  std::unique_ptr<nfc::NfcTag> tag;
+};
+
+class PN7150 : public nfc::Nfcc, public Component {
+ public:
+  void setup() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::DATA; }
+  void loop() override;
+
+  void set_irq_pin(GPIOPin *irq_pin) { this->irq_pin_ = irq_pin; }
+  void set_ven_pin(GPIOPin *ven_pin) { this->ven_pin_ = ven_pin; }
+  void set_tag_ttl(uint32_t ttl) { this->tag_ttl_ = ttl; }
+  void set_discovery_period(uint16_t period) { this->discovery_period_ = period; }
+
+  /// Adds a protocol -> RF interface mapping to the RF_DISCOVER_MAP_CMD sent to the NFCC
+  void add_discover_map_entry(uint8_t protocol, uint8_t interface) {
+    this->discover_map_.push_back(protocol);
+    this->discover_map_.push_back(nfc::RF_DISCOVER_MAP_MODE_POLL);
+    this->discover_map_.push_back(interface);
+  }
+  /// Adds an RF technology & mode to the set the NFCC polls for during autonomous discovery
+  void add_discovery_technology(uint8_t tech_mode) { this->discovery_techs_.push_back(tech_mode); }
+
+  void register_ontag_trigger(nfc::NfcOnTagTrigger *trig) { this->triggers_ontag_.push_back(trig); }
+  void register_ontagremoved_trigger(nfc::NfcOnTagTrigger *trig) { this->triggers_ontagremoved_.push_back(trig); }
+
+ protected:
+  uint8_t reset_core_(bool reset_config, bool power);
+  uint8_t init_core_();
+  uint8_t send_core_config_();
+  uint8_t set_discover_map_();
+  uint8_t start_discovery_();
+  uint8_t deactivate_(uint8_t type, uint16_t timeout = NFCC_DEFAULT_TIMEOUT);
+  bool init_nfcc_();
+
+  void select_endpoint_();
+  uint8_t read_endpoint_data_(uint8_t protocol, nfc::NfcTag &tag);
+  std::unique_ptr<nfc::NfcTag> build_tag_(uint8_t mode_tech, const nfc::NciMessage &rx);
+  optional<size_t> find_tag_uid_(const std::vector<uint8_t> &uid);
+  void purge_old_tags_();
+  void erase_tag_(uint8_t tag_index);
+
+  /// set new controller state
+  void nci_fsm_set_state_(NCIState new_state);
+  /// setting controller to this state caused an error; returns true if too many errors/failures
+  bool nci_fsm_set_error_state_(NCIState new_state);
+
+  /// parse & process incoming messages from the NFCC
+  void process_message_();
+  void process_rf_intf_activated_oid_(nfc::NciMessage &rx);
+  void process_rf_discover_oid_(nfc::NciMessage &rx);
+  void process_rf_deactivate_oid_(nfc::NciMessage &rx);
+
+  /// sends a control command and waits for its response
+  uint8_t transceive_(nfc::NciMessage &tx, nfc::NciMessage &rx, uint16_t timeout = NFCC_DEFAULT_TIMEOUT);
+  /// sends data to the active endpoint and appends its (reassembled) answer to rx_data
+  uint8_t exchange_data_(const uint8_t *tx_data, size_t tx_len, std::vector<uint8_t> &rx_data,
+                         uint16_t timeout = NFCC_DEFAULT_TIMEOUT);
+  /// segments data into packets of at most max_payload_size_ bytes, sending each as soon as a credit is available
+  uint8_t write_data_(const uint8_t *data, size_t len, uint16_t timeout = NFCC_DEFAULT_TIMEOUT);
+  /// appends the payloads of a PBF-chained sequence of data packets to data
+  uint8_t read_data_(std::vector<uint8_t> &data, uint16_t timeout = NFCC_DEFAULT_TIMEOUT);
+  uint8_t wait_for_credits_(uint16_t timeout = NFCC_DEFAULT_TIMEOUT);
+  /// returns true if rx was a CORE_CONN_CREDITS_NTF (and the credits it carried were taken)
+  bool process_conn_credits_(const nfc::NciMessage &rx);
+  virtual uint8_t read_nfcc(nfc::NciMessage &rx, uint16_t timeout) = 0;
+  virtual uint8_t write_nfcc(nfc::NciMessage &tx) = 0;
+
+  uint8_t wait_for_irq_(uint16_t timeout = NFCC_DEFAULT_TIMEOUT, bool pin_state = true);
+
+  uint8_t read_mifare_ultralight_tag_(nfc::NfcTag &tag);
+  uint8_t read_mifare_ultralight_bytes_(uint16_t start_page, uint16_t num_bytes, std::vector<uint8_t> &data);
+  bool is_mifare_ultralight_formatted_(const std::vector<uint8_t> &page_3_to_6);
+  bool find_mifare_ultralight_ndef_(const std::vector<uint8_t> &page_3_to_6, uint16_t &message_length,
+                                    uint8_t &message_start_index);
+
+  uint8_t error_count_{0};
+  uint8_t nci_version_{NCI_VERSION_1_0};
+  uint8_t max_payload_size_{0};
+  uint8_t initial_credits_{0};
+  uint8_t credits_{0};
+  uint8_t selecting_endpoint_{0};
+  uint8_t selecting_protocol_{nfc::PROT_UNDETERMINED};
+  uint16_t discovery_period_{300};
+  uint32_t last_nci_state_change_{0};
+  uint32_t tag_ttl_{1000};
+
+  GPIOPin *irq_pin_{nullptr};
+  GPIOPin *ven_pin_{nullptr};
+
+  std::vector<uint8_t> discover_map_;
+  std::vector<uint8_t> discovery_techs_;
+  std::vector<DiscoveredEndpoint> discovered_endpoint_;
+
+  NCIState nci_state_{NCIState::NFCC_RESET};
+  NCIState nci_state_error_{NCIState::NONE};
+
+  std::vector<nfc::NfcOnTagTrigger *> triggers_ontag_;
+  std::vector<nfc::NfcOnTagTrigger *> triggers_ontagremoved_;
+};
+
+}  // namespace pn7150
+}  // namespace esphome
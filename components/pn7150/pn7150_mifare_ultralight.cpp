@@ -0,0 +1,129 @@
+#include <memory>
+#include <algorithm>
+
+#include "pn7150.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace pn7150 {
+
+static const char *const TAG = "pn7150.mifare_ultralight";
+
+uint8_t PN7150::read_mifare_ultralight_tag_(nfc::NfcTag &tag) {
+  std::vector<uint8_t> data;
+  // pages 3 to 6 contain various info we are interested in -- do one read to grab it all
+  if (this->read_mifare_ultralight_bytes_(3, nfc::MIFARE_ULTRALIGHT_PAGE_SIZE * nfc::MIFARE_ULTRALIGHT_READ_SIZE,
+                                          data) != nfc::STATUS_OK) {
+    return nfc::STATUS_FAILED;
+  }
+
+  if (!this->is_mifare_ultralight_formatted_(data)) {
+    ESP_LOGW(TAG, "Not NDEF formatted");
+    return nfc::STATUS_OK;
+  }
+
+  uint16_t message_length;
+  uint8_t message_start_index;
+  if (!this->find_mifare_ultralight_ndef_(data, message_length, message_start_index)) {
+    ESP_LOGW(TAG, "Couldn't find NDEF message");
+    return nfc::STATUS_FAILED;
+  }
+  ESP_LOGVV(TAG, "NDEF message length: %u, start: %u", message_length, message_start_index);
+
+  if (message_length == 0) {
+    return nfc::STATUS_OK;
+  }
+  // we already read pages 3-6 earlier -- pick up where we left off so we're not re-reading pages
+  const uint16_t read_length =
+      message_length + message_start_index > 12 ? message_length + message_start_index - 12 : 0;
+  if (read_length) {
+    if (this->read_mifare_ultralight_bytes_(nfc::MIFARE_ULTRALIGHT_DATA_START_PAGE + 3, read_length, data) !=
+        nfc::STATUS_OK) {
+      ESP_LOGE(TAG, "Error reading tag data");
+      return nfc::STATUS_FAILED;
+    }
+  }
+  // we need to trim off page 3 as well as any bytes ahead of message_start_index
+  data.erase(data.begin(), data.begin() + message_start_index + nfc::MIFARE_ULTRALIGHT_PAGE_SIZE);
+  if (data.size() > message_length) {
+    data.resize(message_length);
+  }
+
+  tag.set_ndef_message(make_unique<nfc::NdefMessage>(data));
+  return nfc::STATUS_OK;
+}
+
+uint8_t PN7150::read_mifare_ultralight_bytes_(const uint16_t start_page, const uint16_t num_bytes,
+                                              std::vector<uint8_t> &data) {
+  const uint8_t read_increment = nfc::MIFARE_ULTRALIGHT_READ_SIZE * nfc::MIFARE_ULTRALIGHT_PAGE_SIZE;
+  uint8_t cmd[] = {nfc::MIFARE_CMD_READ, 0x00};
+  data.reserve(data.size() + num_bytes + 1);
+
+  for (uint16_t i = 0; i * read_increment < num_bytes; i++) {
+    const uint16_t page = start_page + i * nfc::MIFARE_ULTRALIGHT_READ_SIZE;
+    // pages past sector 0's data area would take SECTOR_SELECT; a READ there would wrap around to page 0 instead
+    if (page > nfc::MIFARE_ULTRALIGHT_SECTOR0_LAST_DATA_PAGE) {
+      ESP_LOGE(TAG, "Page %u is past the data area", page);
+      return nfc::STATUS_FAILED;
+    }
+    cmd[1] = page;
+    const size_t start = data.size();
+    if (this->exchange_data_(cmd, sizeof(cmd), data) != nfc::STATUS_OK) {
+      data.resize(start);
+      return nfc::STATUS_FAILED;
+    }
+    // the frame RF interface appends a status byte to the data received from the endpoint
+    if (data.size() < start + read_increment + 1 || data.back() != nfc::STATUS_OK) {
+      ESP_LOGE(TAG, "Error reading page %u", cmd[1]);
+      data.resize(start);
+      return nfc::STATUS_FAILED;
+    }
+
+    uint16_t bytes_remaining = num_bytes - i * read_increment;
+    data.resize(start + std::min<uint16_t>(bytes_remaining, read_increment));
+  }
+
+  ESP_LOGVV(TAG, "Data read: %s", nfc::format_bytes(data).c_str());
+
+  return nfc::STATUS_OK;
+}
+
+bool PN7150::is_mifare_ultralight_formatted_(const std::vector<uint8_t> &page_3_to_6) {
+  const uint8_t p4_offset = nfc::MIFARE_ULTRALIGHT_PAGE_SIZE;  // page 4 will begin 4 bytes into the vector
+
+  return (page_3_to_6.size() > p4_offset + 3) &&
+         ((page_3_to_6[p4_offset + 0] != 0xFF) || (page_3_to_6[p4_offset + 1] != 0xFF) ||
+          (page_3_to_6[p4_offset + 2] != 0xFF) || (page_3_to_6[p4_offset + 3] != 0xFF));
+}
+
+bool PN7150::find_mifare_ultralight_ndef_(const std::vector<uint8_t> &page_3_to_6, uint16_t &message_length,
+                                          uint8_t &message_start_index) {
+  const uint8_t p4_offset = nfc::MIFARE_ULTRALIGHT_PAGE_SIZE;  // page 4 will begin 4 bytes into the vector
+
+  if (!(page_3_to_6.size() > p4_offset + 7)) {
+    return false;
+  }
+
+  // the NDEF TLV either starts page 4 or follows a five byte lock control TLV
+  uint8_t tlv_offset = 0;
+  if (page_3_to_6[p4_offset + 0] == 0x03) {
+    tlv_offset = 0;
+  } else if (page_3_to_6[p4_offset + 5] == 0x03) {
+    tlv_offset = 5;
+  } else {
+    return false;
+  }
+
+  if (page_3_to_6[p4_offset + tlv_offset + 1] == 0xFF) {
+    // three byte length format: 0xFF, then the length, high byte first
+    message_length = (page_3_to_6[p4_offset + tlv_offset + 2] << 8) | page_3_to_6[p4_offset + tlv_offset + 3];
+    message_start_index = tlv_offset + 4;
+  } else {
+    message_length = page_3_to_6[p4_offset + tlv_offset + 1];
+    message_start_index = tlv_offset + 2;
+  }
+  return true;
+}
+
+}  // namespace pn7150
+}  // namespace esphome
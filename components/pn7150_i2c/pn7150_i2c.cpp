@@ -0,0 +1,49 @@
+#include "pn7150_i2c.h"
+#include "esphome/core/log.h"
+#include "esphome/core/hal.h"
+
+namespace esphome {
+namespace pn7150_i2c {
+
+static const char *const TAG = "pn7150_i2c";
+
+uint8_t PN7150I2C::read_nfcc(nfc::NciMessage &rx, const uint16_t timeout) {
+  if (this->wait_for_irq_(timeout) != nfc::STATUS_OK) {
+    ESP_LOGW(TAG, "read_nfcc() timeout waiting for IRQ");
+    return nfc::STATUS_FAILED;
+  }
+
+  // the buffer always has room for the largest packet, so read straight into it
+  if (this->read(rx.data(), nfc::NCI_PKT_HEADER_SIZE) != i2c::ERROR_OK) {
+    return nfc::STATUS_FAILED;
+  }
+
+  uint8_t length = rx.get_payload_size();
+  if (length > 0) {
+    if (this->read(rx.payload(), length) != i2c::ERROR_OK) {
+      return nfc::STATUS_FAILED;
+    }
+  }
+  // semaphore to ensure transaction is complete before returning
+  if (this->wait_for_irq_(pn7150::NFCC_DEFAULT_TIMEOUT, false) != nfc::STATUS_OK) {
+    ESP_LOGW(TAG, "read_nfcc() post-read timeout waiting for IRQ line to clear");
+    return nfc::STATUS_FAILED;
+  }
+  return nfc::STATUS_OK;
+}
+
+uint8_t PN7150I2C::write_nfcc(nfc::NciMessage &tx) {
+  auto packet = tx.encode();
+  if (this->write(packet.data(), packet.size()) == i2c::ERROR_OK) {
+    return nfc::STATUS_OK;
+  }
+  return nfc::STATUS_FAILED;
+}
+
+void PN7150I2C::dump_config() {
+  PN7150::dump_config();
+  LOG_I2C_DEVICE(this);
+}
+
+}  // namespace pn7150_i2c
+}  // namespace esphome
@@ -0,0 +1,57 @@
+from esphome import automation
+import esphome.codegen as cg
+from esphome.components import sensor, time
+import esphome.config_validation as cv
+from esphome.const import CONF_ID, CONF_SENSOR_ID, CONF_TIME_ID, CONF_TRIGGER_ID
+
+DEPENDENCIES = ["api", "time"]
+
+CONF_ON_FLUSH = "on_flush"
+CONF_PAGES = "pages"
+CONF_RESOLUTION = "resolution"
+
+reading_buffer_ns = cg.esphome_ns.namespace("reading_buffer")
+ReadingBuffer = reading_buffer_ns.class_("ReadingBuffer", cg.Component)
+
+ReadingBufferFlushTrigger = reading_buffer_ns.class_(
+    "ReadingBufferFlushTrigger", automation.Trigger.template(cg.uint32, cg.float_)
+)
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(ReadingBuffer),
+        cv.GenerateID(CONF_TIME_ID): cv.use_id(time.RealTimeClock),
+        cv.Optional(CONF_SENSOR_ID): cv.use_id(sensor.Sensor),
+        # each page holds one base reading plus 16 delta-encoded ones
+        cv.Optional(CONF_PAGES, default=4): cv.int_range(min=2, max=32),
+        # stored values are integers in 1/resolution units; deltas between readings must stay below 65536 units
+        cv.Optional(CONF_RESOLUTION, default=1000): cv.int_range(min=1),
+        # flushing empties the buffer, so the readings need somewhere to go
+        cv.Required(CONF_ON_FLUSH): automation.validate_automation(
+            {
+                cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(
+                    ReadingBufferFlushTrigger
+                ),
+            }
+        ),
+    }
+).extend(cv.COMPONENT_SCHEMA)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+
+    time_ = await cg.get_variable(config[CONF_TIME_ID])
+    cg.add(var.set_time(time_))
+    if CONF_SENSOR_ID in config:
+        sens = await cg.get_variable(config[CONF_SENSOR_ID])
+        cg.add(var.set_sensor(sens))
+    cg.add(var.set_num_pages(config[CONF_PAGES]))
+    cg.add(var.set_resolution(config[CONF_RESOLUTION]))
+
+    for conf in config[CONF_ON_FLUSH]:
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(
+            trigger, [(cg.uint32, "timestamp"), (cg.float_, "value")], conf
+        )
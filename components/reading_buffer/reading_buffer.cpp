@@ -0,0 +1,155 @@
+#include "reading_buffer.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+
+#ifdef USE_API
+#include "esphome/components/api/api_server.h"
+#endif
+
+#include <cinttypes>
+#include <cmath>
+
+namespace esphome {
+namespace reading_buffer {
+
+static const char *const TAG = "reading_buffer";
+
+void ReadingBuffer::setup() {
+  const uint32_t key = fnv1_hash("reading_buffer");
+  this->page_readings_.resize(this->num_pages_, 0);
+
+  // the page with the highest sequence number is the one that was being filled before the restart
+  uint32_t newest = 0;
+  for (uint8_t i = 0; i < this->num_pages_; i++) {
+    this->prefs_.push_back(global_preferences->make_preference<ReadingPage>(key + i, true));
+    ReadingPage page{};
+    if (!this->prefs_[i].load(&page) || page.sequence == 0 || page.count > READING_BUFFER_RECORDS_PER_PAGE) {
+      continue;
+    }
+    this->page_readings_[i] = page.count + 1;
+    this->buffered_count_ += page.count + 1;
+    if (page.sequence > newest) {
+      newest = page.sequence;
+      this->current_page_ = i;
+      this->page_ = page;
+    }
+  }
+
+  if (newest != 0) {
+    this->next_sequence_ = newest + 1;
+    this->last_time_ = this->page_.base_time;
+    this->last_value_ = this->page_.base_value;
+    for (uint8_t i = 0; i < this->page_.count; i++) {
+      this->last_time_ += this->page_.records[i].time_delta;
+      this->last_value_ += this->page_.records[i].value_delta;
+    }
+  }
+}
+
+void ReadingBuffer::loop() {
+  if (this->buffered_count_ != 0 && this->api_connected_()) {
+    this->flush_();
+  }
+}
+
+void ReadingBuffer::dump_config() {
+  ESP_LOGCONFIG(TAG, "Reading Buffer:");
+  ESP_LOGCONFIG(TAG, "  Pages: %u of %u readings", this->num_pages_, READING_BUFFER_RECORDS_PER_PAGE + 1);
+  ESP_LOGCONFIG(TAG, "  Resolution: 1/%" PRIu32, this->resolution_);
+  ESP_LOGCONFIG(TAG, "  Buffered readings: %" PRIu32, this->buffered_count_);
+}
+
+void ReadingBuffer::add_reading(float value) {
+  if (this->sensor_ != nullptr) {
+    this->sensor_->publish_state(value);
+  }
+  if (this->api_connected_()) {
+    return;
+  }
+
+  auto now = this->time_->now();
+  if (!now.is_valid()) {
+    ESP_LOGW(TAG, "Time not synchronized; reading %f not buffered", value);
+    return;
+  }
+  this->store_(now.timestamp, lroundf(value * this->resolution_));
+}
+
+bool ReadingBuffer::api_connected_() {
+#ifdef USE_API
+  return api::global_api_server != nullptr && api::global_api_server->is_connected();
+#else
+  return false;
+#endif
+}
+
+void ReadingBuffer::store_(const uint32_t timestamp, const int32_t value) {
+  const bool fits = this->page_.sequence != 0 && this->page_.count < READING_BUFFER_RECORDS_PER_PAGE &&
+                    timestamp >= this->last_time_ && timestamp - this->last_time_ <= UINT16_MAX &&
+                    value >= this->last_value_ && value - this->last_value_ <= UINT16_MAX;
+
+  if (fits) {
+    this->page_.records[this->page_.count++] = {uint16_t(timestamp - this->last_time_),
+                                                uint16_t(value - this->last_value_)};
+  } else {
+    // start the next page with a new base reading; a full buffer loses its oldest page
+    this->current_page_ = (this->current_page_ + 1) % this->num_pages_;
+    if (this->page_readings_[this->current_page_] != 0) {
+      ESP_LOGW(TAG, "Buffer full, dropping %u oldest readings", this->page_readings_[this->current_page_]);
+      this->buffered_count_ -= this->page_readings_[this->current_page_];
+      this->page_readings_[this->current_page_] = 0;
+    }
+    this->page_ = {};
+    this->page_.sequence = this->next_sequence_++;
+    this->page_.base_time = timestamp;
+    this->page_.base_value = value;
+  }
+
+  this->last_time_ = timestamp;
+  this->last_value_ = value;
+  this->page_readings_[this->current_page_]++;
+  this->buffered_count_++;
+  this->prefs_[this->current_page_].save(&this->page_);
+  ESP_LOGD(TAG, "Buffered reading %" PRIu32 ": %.3f at %" PRIu32, this->buffered_count_,
+           float(value) / this->resolution_, timestamp);
+}
+
+void ReadingBuffer::flush_() {
+  ESP_LOGD(TAG, "Flushing %" PRIu32 " buffered readings", this->buffered_count_);
+
+  // pages are filled in rotation, so the one after the current page holds the oldest readings
+  for (uint8_t n = 1; n <= this->num_pages_; n++) {
+    const uint8_t index = (this->current_page_ + n) % this->num_pages_;
+    if (this->page_readings_[index] == 0) {
+      continue;
+    }
+
+    ReadingPage page{};
+    if (index == this->current_page_) {
+      page = this->page_;
+    } else {
+      this->prefs_[index].load(&page);
+    }
+
+    if (page.sequence != 0 && page.count <= READING_BUFFER_RECORDS_PER_PAGE) {
+      uint32_t timestamp = page.base_time;
+      int32_t value = page.base_value;
+      this->flush_callback_.call(timestamp, float(value) / this->resolution_);
+      for (uint8_t i = 0; i < page.count; i++) {
+        timestamp += page.records[i].time_delta;
+        value += page.records[i].value_delta;
+        this->flush_callback_.call(timestamp, float(value) / this->resolution_);
+      }
+    }
+
+    page = {};
+    this->prefs_[index].save(&page);
+    this->page_readings_[index] = 0;
+  }
+
+  this->page_ = {};
+  this->buffered_count_ = 0;
+}
+
+}  // namespace reading_buffer
+}  // namespace esphome
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "esphome/core/automation.h"
+#include "esphome/core/component.h"
+#include "esphome/core/defines.h"
+#include "esphome/core/preferences.h"
+#include "esphome/components/sensor/sensor.h"
+#include "esphome/components/time/real_time_clock.h"
+
+#include <vector>
+
+namespace esphome {
+namespace reading_buffer {
+
+static const uint8_t READING_BUFFER_RECORDS_PER_PAGE = 16;
+
+/// A reading relative to the one before it
+struct ReadingRecord {
+  uint16_t time_delta;   // seconds
+  uint16_t value_delta;  // in 1/resolution units
+} __attribute__((packed));
+
+/// A base reading followed by up to READING_BUFFER_RECORDS_PER_PAGE delta-encoded ones. Each page is its own
+/// preference and pages are filled in rotation, so writes are spread across all of them.
+struct ReadingPage {
+  uint32_t sequence;  // 0 if the page is empty
+  uint32_t base_time;
+  int32_t base_value;
+  uint8_t count;
+  ReadingRecord records[READING_BUFFER_RECORDS_PER_PAGE];
+} __attribute__((packed));
+
+class ReadingBuffer : public Component {
+ public:
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::DATA; }
+
+  void set_time(time::RealTimeClock *time) { this->time_ = time; }
+  void set_sensor(sensor::Sensor *sensor) { this->sensor_ = sensor; }
+  void set_num_pages(uint8_t num_pages) { this->num_pages_ = num_pages; }
+  void set_resolution(uint32_t resolution) { this->resolution_ = resolution; }
+
+  void add_on_flush_callback(std::function<void(uint32_t, float)> &&callback) {
+    this->flush_callback_.add(std::move(callback));
+  }
+
+  /// Publishes the reading to the sensor and, while the API is disconnected, stores it until the next connection
+  void add_reading(float value);
+  uint32_t get_buffered_count() const { return this->buffered_count_; }
+
+ protected:
+  bool api_connected_();
+  void store_(uint32_t timestamp, int32_t value);
+  /// replays all stored readings, oldest first, through the flush callbacks and empties the buffer
+  void flush_();
+
+  time::RealTimeClock *time_{nullptr};
+  sensor::Sensor *sensor_{nullptr};
+  std::vector<ESPPreferenceObject> prefs_;
+  std::vector<uint8_t> page_readings_;  // readings held by each page
+  ReadingPage page_{};                  // the page being filled
+  uint8_t num_pages_{4};
+  uint8_t current_page_{0};
+  uint32_t next_sequence_{1};
+  uint32_t last_time_{0};
+  int32_t last_value_{0};
+  uint32_t resolution_{1000};
+  uint32_t buffered_count_{0};
+  CallbackManager<void(uint32_t, float)> flush_callback_;
+};
+
+class ReadingBufferFlushTrigger : public Trigger<uint32_t, float> {
+ public:
+  explicit ReadingBufferFlushTrigger(ReadingBuffer *parent) {
+    parent->add_on_flush_callback([this](uint32_t timestamp, float value) { this->trigger(timestamp, value); });
+  }
+};
+
+}  // namespace reading_buffer
+}  // namespace esphome
@@ -0,0 +1,106 @@
+from esphome import automation
+import esphome.codegen as cg
+from esphome.components import nfc, text_sensor
+import esphome.config_validation as cv
+from esphome.const import CONF_ID, CONF_TRIGGER_ID
+
+DEPENDENCIES = ["nfc"]
+AUTO_LOAD = ["text_sensor"]
+
+CONF_CBOR_EVENT = "cbor_event"
+CONF_CRC_ALGORITHM = "crc_algorithm"
+CONF_HISTORY = "history"
+CONF_NFCC_ID = "nfcc_id"
+CONF_ON_HISTORY_ENTRY = "on_history_entry"
+
+water_meter_ns = cg.esphome_ns.namespace("water_meter")
+WaterMeter = water_meter_ns.class_("WaterMeter", cg.Component, nfc.NfcTagListener)
+
+CrcAlgorithm = water_meter_ns.enum("CrcAlgorithm")
+CRC_ALGORITHMS = {
+    "none": CrcAlgorithm.CRC_ALGORITHM_NONE,
+    "auto": CrcAlgorithm.CRC_ALGORITHM_AUTO,
+    "ccitt_false": CrcAlgorithm.CRC_ALGORITHM_CCITT_FALSE,
+    "xmodem": CrcAlgorithm.CRC_ALGORITHM_XMODEM,
+    "kermit": CrcAlgorithm.CRC_ALGORITHM_KERMIT,
+    "modbus": CrcAlgorithm.CRC_ALGORITHM_MODBUS,
+}
+
+WaterMeterHistoryEntryTrigger = water_meter_ns.class_(
+    "WaterMeterHistoryEntryTrigger",
+    automation.Trigger.template(cg.std_string, cg.std_string, cg.std_string),
+)
+WaterMeterPublishHistoryAction = water_meter_ns.class_(
+    "WaterMeterPublishHistoryAction", automation.Action
+)
+
+
+def validate_event_name(value):
+    value = cv.string(value)
+    if not value.startswith("esphome."):
+        raise cv.Invalid(
+            "Home Assistant only accepts events from ESPHome named esphome.*"
+        )
+    return value
+
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(WaterMeter),
+        cv.GenerateID(CONF_NFCC_ID): cv.use_id(nfc.Nfcc),
+        cv.Optional(CONF_CRC_ALGORITHM, default="auto"): cv.enum(
+            CRC_ALGORITHMS, lower=True
+        ),
+        cv.Optional(CONF_CBOR_EVENT): cv.All(
+            cv.requires_component("api"), validate_event_name
+        ),
+        cv.Optional(CONF_HISTORY): text_sensor.text_sensor_schema(
+            icon="mdi:history"
+        ),
+        cv.Optional(CONF_ON_HISTORY_ENTRY): automation.validate_automation(
+            {
+                cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(
+                    WaterMeterHistoryEntryTrigger
+                ),
+            }
+        ),
+    }
+).extend(cv.COMPONENT_SCHEMA)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+
+    hub = await cg.get_variable(config[CONF_NFCC_ID])
+    cg.add(hub.register_listener(var))
+    cg.add(var.set_crc_algorithm(config[CONF_CRC_ALGORITHM]))
+    if CONF_CBOR_EVENT in config:
+        cg.add(var.set_cbor_event(config[CONF_CBOR_EVENT]))
+
+    if CONF_HISTORY in config:
+        sens = await text_sensor.new_text_sensor(config[CONF_HISTORY])
+        cg.add(var.set_history_text_sensor(sens))
+
+    for conf in config.get(CONF_ON_HISTORY_ENTRY, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(
+            trigger,
+            [(cg.std_string, "serial"), (cg.std_string, "date"), (cg.std_string, "value")],
+            conf,
+        )
+
+
+@automation.register_action(
+    "water_meter.publish_history",
+    WaterMeterPublishHistoryAction,
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.use_id(WaterMeter),
+        }
+    ),
+)
+async def water_meter_publish_history_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    return var
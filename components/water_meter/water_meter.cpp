@@ -0,0 +1,298 @@
+#include "water_meter.h"
+#include "esphome/components/nfc/cbor_writer.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+
+#ifdef USE_API
+#include "esphome/components/api/api_server.h"
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace esphome {
+namespace water_meter {
+
+static const char *const TAG = "water_meter";
+
+static void trim(const char *&text, size_t &length) {
+  while (length > 0 && (*text == ' ' || *text == '\t')) {
+    text++;
+    length--;
+  }
+  while (length > 0 && (text[length - 1] == ' ' || text[length - 1] == '\t')) {
+    length--;
+  }
+}
+
+static const char *crc_algorithm_to_string(CrcAlgorithm algorithm) {
+  switch (algorithm) {
+    case CRC_ALGORITHM_NONE:
+      return "none";
+    case CRC_ALGORITHM_AUTO:
+      return "auto";
+    case CRC_ALGORITHM_CCITT_FALSE:
+      return "CRC-16/CCITT-FALSE";
+    case CRC_ALGORITHM_XMODEM:
+      return "CRC-16/XMODEM";
+    case CRC_ALGORITHM_KERMIT:
+      return "CRC-16/KERMIT";
+    case CRC_ALGORITHM_MODBUS:
+      return "CRC-16/MODBUS";
+    default:
+      return "unknown";
+  }
+}
+
+static bool is_date(const std::string &key) { return key.length() == 10 && key[4] == '-' && key[7] == '-'; }
+
+void parse_meter_payload(const std::string &payload, const MeterLineCallback &callback) {
+  const size_t end = payload.find("CRC");
+  size_t pos = 0;
+  bool first_line = true;
+
+  while (pos < end) {
+    const size_t eol = payload.find("\r\n", pos);
+    if (eol == std::string::npos || eol > end) {
+      break;
+    }
+    const char *line = payload.data() + pos;
+    const size_t line_length = eol - pos;
+    pos = eol + 2;
+
+    if (first_line) {
+      first_line = false;
+      callback(nullptr, 0, line, line_length);
+      continue;
+    }
+
+    const auto *delimiter = static_cast<const char *>(std::memchr(line, ':', line_length));
+    if (delimiter == nullptr) {
+      continue;
+    }
+    const char *key = line;
+    size_t key_length = delimiter - line;
+    const char *value = delimiter + 1;
+    size_t value_length = line + line_length - value;
+    trim(key, key_length);
+    trim(value, value_length);
+    callback(key, key_length, value, value_length);
+  }
+}
+
+bool decode_meter_payload(const std::string &payload, MeterPayload &meter) {
+  parse_meter_payload(payload, [&meter](const char *key, size_t key_length, const char *value, size_t value_length) {
+    if (key == nullptr) {
+      meter.name.assign(value, value_length);
+      return;
+    }
+    std::string key_str(key, key_length);
+    if (is_date(key_str)) {
+      meter.history.push_back({std::move(key_str), std::string(value, value_length)});
+    } else if (key_str == "S/N") {
+      meter.serial.assign(value, value_length);
+    } else {
+      meter.fields.emplace_back(std::move(key_str), std::string(value, value_length));
+    }
+  });
+
+  return !meter.serial.empty();
+}
+
+bool find_meter_crc(const std::string &payload, size_t &covered, uint16_t &crc) {
+  covered = payload.find("CRC");
+  if (covered == std::string::npos) {
+    return false;
+  }
+  // "CRC: 1A2B", "CRC 1A2B", "CRC=1A2B"
+  const size_t digits = payload.find_first_of("0123456789abcdefABCDEF", covered + 3);
+  if (digits == std::string::npos) {
+    return false;
+  }
+  char *end;
+  const unsigned long value = strtoul(payload.c_str() + digits, &end, 16);
+  if (end == payload.c_str() + digits || value > 0xFFFF) {
+    return false;
+  }
+  crc = value;
+  return true;
+}
+
+uint16_t calculate_meter_crc(const std::string &payload, const size_t covered, const CrcAlgorithm algorithm) {
+  const auto *data = reinterpret_cast<const uint8_t *>(payload.data());
+  switch (algorithm) {
+    case CRC_ALGORITHM_CCITT_FALSE:
+      return crc16be(data, covered, 0xFFFF, 0x1021);
+    case CRC_ALGORITHM_XMODEM:
+      return crc16be(data, covered, 0x0000, 0x1021);
+    case CRC_ALGORITHM_KERMIT:
+      return crc16(data, covered, 0x0000, 0x8408);
+    case CRC_ALGORITHM_MODBUS:
+      return crc16(data, covered, 0xFFFF, 0xA001);
+    default:
+      return 0;
+  }
+}
+
+void WaterMeter::dump_config() {
+  ESP_LOGCONFIG(TAG, "Water Meter:");
+  ESP_LOGCONFIG(TAG, "  CRC check: %s", crc_algorithm_to_string(this->crc_algorithm_));
+  if (!this->cbor_event_.empty()) {
+    ESP_LOGCONFIG(TAG, "  CBOR event: %s", this->cbor_event_.c_str());
+  }
+  LOG_TEXT_SENSOR("  ", "History", this->history_);
+}
+
+bool WaterMeter::ndef_message_is_valid(nfc::NdefMessage &message) {
+  const auto &records = message.get_records();
+  return records.empty() || this->crc_is_valid_(records[0]->get_payload());
+}
+
+void WaterMeter::tag_on(nfc::NfcTag &tag) {
+  if (!tag.has_ndef_message()) {
+    return;
+  }
+  const auto &records = tag.get_ndef_message()->get_records();
+  if (records.empty()) {
+    return;
+  }
+
+  if (!this->crc_is_valid_(records[0]->get_payload())) {
+    ESP_LOGW(TAG, "Tag '%s' failed the CRC check, ignoring it", nfc::format_uid(tag.get_uid()).c_str());
+    return;
+  }
+
+  MeterPayload payload;
+  if (!decode_meter_payload(records[0]->get_payload(), payload)) {
+    ESP_LOGV(TAG, "Tag '%s' does not carry a meter record", nfc::format_uid(tag.get_uid()).c_str());
+    return;
+  }
+
+  auto &meter = this->find_meter_(payload.serial);
+  uint8_t published = 0;
+  for (auto &entry : payload.history) {
+    auto known = std::find_if(meter.entries.begin(), meter.entries.end(),
+                              [&entry](const HistoryEntry &e) { return e.date == entry.date; });
+    if (known != meter.entries.end() && known->value == entry.value) {
+      continue;
+    }
+
+    this->history_entry_callback_.call(meter.serial, entry.date, entry.value);
+    published++;
+    if (known != meter.entries.end()) {
+      known->value = entry.value;
+    } else {
+      meter.entries.push_back(entry);
+    }
+  }
+  ESP_LOGD(TAG, "Meter %s: %u of %u history entries new or changed", meter.serial.c_str(), published,
+           payload.history.size());
+
+  if (!this->cbor_event_.empty()) {
+    this->send_cbor_event_(tag, records[0]->get_payload());
+  }
+}
+
+void WaterMeter::send_cbor_event_(nfc::NfcTag &tag, const std::string &payload) {
+#ifdef USE_API
+  if (api::global_api_server == nullptr || !api::global_api_server->is_connected()) {
+    return;
+  }
+
+  // one flat map: the tag's UID and type, the meter's name, then its lines as they are, dated ones included
+  nfc::CborWriter writer(this->cbor_buffer_.data(), this->cbor_buffer_.size());
+  writer.begin_map();
+  writer.write_text("uid", 3);
+  writer.write_bytes(tag.get_uid().data(), tag.get_uid().size());
+  writer.write_text("type", 4);
+  writer.write_text(tag.get_tag_type());
+  parse_meter_payload(payload, [&writer](const char *key, size_t key_length, const char *value, size_t value_length) {
+    if (key == nullptr) {
+      writer.write_text("name", 4);
+    } else {
+      writer.write_text(key, key_length);
+    }
+    writer.write_text(value, value_length);
+  });
+  writer.end();
+  if (writer.overflowed()) {
+    ESP_LOGW(TAG, "Meter record does not fit the %u byte CBOR buffer", this->cbor_buffer_.size());
+    return;
+  }
+
+  // event data can only be text, so the CBOR travels base64 encoded
+  api::HomeassistantServiceResponse event;
+  event.service = this->cbor_event_;
+  event.is_event = true;
+  api::HomeassistantServiceMap data;
+  data.key = "cbor";
+  data.value = base64_encode(writer.data(), writer.size());
+  event.data.push_back(data);
+  api::global_api_server->send_homeassistant_service_call(event);
+  ESP_LOGD(TAG, "Sent %u byte CBOR event %s", writer.size(), this->cbor_event_.c_str());
+#endif
+}
+
+void WaterMeter::publish_history() {
+  if (this->history_ == nullptr || this->meters_.empty()) {
+    return;
+  }
+
+  const auto &meter = this->meters_.back();
+  std::string json = "{\"SN\": \"" + meter.serial + "\", \"history\": [";
+  for (const auto &entry : meter.entries) {
+    json += "{\"date\": \"" + entry.date + "\", \"volume\": \"" + entry.value + "\"},";
+  }
+  if (json.back() == ',') {
+    json.pop_back();
+  }
+  json += "]}";
+  this->history_->publish_state(json);
+}
+
+bool WaterMeter::crc_is_valid_(const std::string &payload) {
+  size_t covered;
+  uint16_t expected;
+  // records that aren't the meter's, or carry no CRC line, are none of our business
+  if (this->crc_algorithm_ == CRC_ALGORITHM_NONE || !find_meter_crc(payload, covered, expected)) {
+    return true;
+  }
+
+  if (this->crc_algorithm_ != CRC_ALGORITHM_AUTO) {
+    const uint16_t crc = calculate_meter_crc(payload, covered, this->crc_algorithm_);
+    if (crc != expected) {
+      ESP_LOGW(TAG, "CRC mismatch: calculated %04X, record says %04X", crc, expected);
+      return false;
+    }
+    return true;
+  }
+
+  for (auto algorithm : {CRC_ALGORITHM_CCITT_FALSE, CRC_ALGORITHM_XMODEM, CRC_ALGORITHM_KERMIT, CRC_ALGORITHM_MODBUS}) {
+    if (calculate_meter_crc(payload, covered, algorithm) == expected) {
+      ESP_LOGI(TAG, "Meter CRC is %s; checking only that from now on", crc_algorithm_to_string(algorithm));
+      this->crc_algorithm_ = algorithm;
+      return true;
+    }
+  }
+  ESP_LOGW(TAG, "CRC %04X matches none of the known variants", expected);
+  return false;
+}
+
+MeterHistory &WaterMeter::find_meter_(const std::string &serial) {
+  auto it = std::find_if(this->meters_.begin(), this->meters_.end(),
+                         [&serial](const MeterHistory &m) { return m.serial == serial; });
+  if (it != this->meters_.end()) {
+    // keep the list ordered by when each meter was last read
+    std::rotate(it, it + 1, this->meters_.end());
+  } else {
+    if (this->meters_.size() >= WATER_METER_MAX_METERS) {
+      this->meters_.erase(this->meters_.begin());
+    }
+    this->meters_.push_back({serial, {}});
+  }
+  return this->meters_.back();
+}
+
+}  // namespace water_meter
+}  // namespace esphome
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "esphome/core/automation.h"
+#include "esphome/core/component.h"
+#include "esphome/components/nfc/nfc.h"
+#include "esphome/components/nfc/nfc_tag.h"
+#include "esphome/components/text_sensor/text_sensor.h"
+
+#include <array>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace water_meter {
+
+// how many meters' histories are remembered; the least recently read one is forgotten first
+static const uint8_t WATER_METER_MAX_METERS = 4;
+// a meter record's fields, CBOR encoded, must fit this
+static const uint16_t WATER_METER_CBOR_BUFFER_SIZE = 512;
+
+struct HistoryEntry {
+  std::string date;
+  std::string value;
+};
+
+struct MeterHistory {
+  std::string serial;
+  std::vector<HistoryEntry> entries;
+};
+
+/// The decoded text record: a name line followed by "Key: Value" lines, with dated keys (YYYY-MM-DD) forming the
+/// history
+struct MeterPayload {
+  std::string name;
+  std::string serial;
+  std::vector<std::pair<std::string, std::string>> fields;
+  std::vector<HistoryEntry> history;
+};
+
+/// Called with the trimmed key and value of every "Key: Value" line; the first line, the meter's name, comes with a
+/// null key. Both point into the payload.
+using MeterLineCallback =
+    std::function<void(const char *key, size_t key_length, const char *value, size_t value_length)>;
+
+/// Walks the meter's text record up to its trailing CRC line without copying any of it
+void parse_meter_payload(const std::string &payload, const MeterLineCallback &callback);
+/// Decodes the meter's text record up to its trailing CRC line; returns false if it carries no serial number
+bool decode_meter_payload(const std::string &payload, MeterPayload &meter);
+
+/// CRC-16 variants the trailing "CRC: XXXX" line may have been computed with
+enum CrcAlgorithm : uint8_t {
+  CRC_ALGORITHM_NONE = 0,  // don't check
+  CRC_ALGORITHM_AUTO,      // the first variant seen to match is kept from then on
+  CRC_ALGORITHM_CCITT_FALSE,
+  CRC_ALGORITHM_XMODEM,
+  CRC_ALGORITHM_KERMIT,
+  CRC_ALGORITHM_MODBUS,
+};
+
+/// Finds the CRC line; `covered` is the length of the text the CRC was computed over, everything ahead of "CRC"
+bool find_meter_crc(const std::string &payload, size_t &covered, uint16_t &crc);
+uint16_t calculate_meter_crc(const std::string &payload, size_t covered, CrcAlgorithm algorithm);
+
+/// Decodes the text record written by the meter ("Name\r\nKey: Value\r\n...CRC...") and reports the dated history
+/// entries it carries only when they are new or their value changed since the meter was last read.
+class WaterMeter : public Component, public nfc::NfcTagListener {
+ public:
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::DATA; }
+
+  void set_history_text_sensor(text_sensor::TextSensor *history) { this->history_ = history; }
+  void add_on_history_entry_callback(std::function<void(std::string, std::string, std::string)> &&callback) {
+    this->history_entry_callback_.add(std::move(callback));
+  }
+
+  void set_crc_algorithm(CrcAlgorithm crc_algorithm) { this->crc_algorithm_ = crc_algorithm; }
+  /// Sends every meter reading to Home Assistant as this event, with the record CBOR encoded
+  void set_cbor_event(const std::string &cbor_event) { this->cbor_event_ = cbor_event; }
+
+  void tag_on(nfc::NfcTag &tag) override;
+  /// Rejects meter records whose CRC doesn't match, so the reader fetches them again
+  bool ndef_message_is_valid(nfc::NdefMessage &message) override;
+
+  /// Publishes the complete history of the meter read last as a JSON array to the history text sensor
+  void publish_history();
+
+ protected:
+  MeterHistory &find_meter_(const std::string &serial);
+  bool crc_is_valid_(const std::string &payload);
+  void send_cbor_event_(nfc::NfcTag &tag, const std::string &payload);
+
+  text_sensor::TextSensor *history_{nullptr};
+  CrcAlgorithm crc_algorithm_{CRC_ALGORITHM_AUTO};
+  std::string cbor_event_;
+  std::array<uint8_t, WATER_METER_CBOR_BUFFER_SIZE> cbor_buffer_;
+  std::vector<MeterHistory> meters_;  // most recently read last
+  CallbackManager<void(std::string, std::string, std::string)> history_entry_callback_;
+};
+
+class WaterMeterHistoryEntryTrigger : public Trigger<std::string, std::string, std::string> {
+ public:
+  explicit WaterMeterHistoryEntryTrigger(WaterMeter *parent) {
+    parent->add_on_history_entry_callback([this](const std::string &serial, const std::string &date,
+                                                 const std::string &value) { this->trigger(serial, date, value); });
+  }
+};
+
+template<typename... Ts> class WaterMeterPublishHistoryAction : public Action<Ts...>, public Parented<WaterMeter> {
+ public:
+  void play(Ts... x) override { this->parent_->publish_history(); }
+};
+
+}  // namespace water_meter
+}  // namespace esphome
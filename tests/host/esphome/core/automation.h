@@ -0,0 +1,17 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+
+template<typename... Ts> class Trigger {
+ public:
+  void add_on_trigger_callback(std::function<void(Ts...)> &&callback) { this->callback_.add(std::move(callback)); }
+  void trigger(Ts... x) { this->callback_.call(x...); }
+
+ protected:
+  CallbackManager<void(Ts...)> callback_;
+};
+
+}  // namespace esphome
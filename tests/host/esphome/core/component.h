@@ -0,0 +1,25 @@
+#pragma once
+
+namespace esphome {
+
+namespace setup_priority {
+static const float HARDWARE = 800.0f;
+static const float DATA = 600.0f;
+}  // namespace setup_priority
+
+class Component {
+ public:
+  virtual ~Component() = default;
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+  virtual float get_setup_priority() const { return setup_priority::DATA; }
+
+  void mark_failed() { this->failed_ = true; }
+  bool is_failed() const { return this->failed_; }
+
+ protected:
+  bool failed_{false};
+};
+
+}  // namespace esphome
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+// Host stand-in for the HAL: time only moves when the code under test waits, so runs are deterministic
+
+namespace esphome {
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+/// advances the clock by one millisecond, so polling loops reach their timeouts
+void yield();
+
+namespace host {
+/// moves the clock forward, e.g. past a tag's time to live
+void advance_millis(uint32_t ms);
+}  // namespace host
+
+}  // namespace esphome
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstdio>
+
+// Host stand-in for ESPHome's logger: everything up to VERBOSE goes to stdout, VERY_VERBOSE is dropped
+
+namespace esphome {
+
+void esp_log_printf_(char level, const char *tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+}  // namespace esphome
+
+#define ESP_LOGE(tag, ...) esphome::esp_log_printf_('E', tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) esphome::esp_log_printf_('W', tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) esphome::esp_log_printf_('I', tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) esphome::esp_log_printf_('D', tag, __VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) esphome::esp_log_printf_('C', tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) esphome::esp_log_printf_('V', tag, __VA_ARGS__)
+#define ESP_LOGVV(tag, ...) \
+  do { \
+    if (false) \
+      esphome::esp_log_printf_('X', tag, __VA_ARGS__); \
+  } while (false)
+
+#define YESNO(b) ((b) ? "YES" : "NO")
+#define LOG_PIN(prefix, pin) (void) (pin)
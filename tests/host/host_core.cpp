@@ -0,0 +1,38 @@
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+
+#include <cstdarg>
+
+namespace esphome {
+
+static uint32_t now_ms = 0;  // NOLINT
+
+uint32_t millis() { return now_ms; }
+uint32_t micros() { return now_ms * 1000; }
+void delay(uint32_t ms) { now_ms += ms; }
+void delayMicroseconds(uint32_t us) { now_ms += (us + 999) / 1000; }
+void yield() { now_ms++; }
+
+namespace host {
+void advance_millis(uint32_t ms) { now_ms += ms; }
+}  // namespace host
+
+uint32_t random_uint32() {
+  static uint32_t state = 0x12345678;  // NOLINT
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+void esp_log_printf_(char level, const char *tag, const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  printf("[%c][%s] ", level, tag);
+  vprintf(format, args);
+  printf("\n");
+  va_end(args);
+}
+
+}  // namespace esphome
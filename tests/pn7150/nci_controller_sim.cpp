@@ -0,0 +1,396 @@
+#include "nci_controller_sim.h"
+#include "esphome/core/hal.h"
+#include "esphome/components/nfc/nfc.h"
+
+#include <algorithm>
+
+namespace esphome {
+namespace pn7150 {
+namespace testing {
+
+// NFC-A technology parameters of the simulated tag: SENS_RES and SEL_RES of an NTAG21x
+static const uint8_t SIM_SENS_RES[] = {0x44, 0x00};
+static const uint8_t SIM_SEL_RES = 0x00;
+// CORE_RESET_NTF reset trigger: the host sent CORE_RESET_CMD
+static const uint8_t SIM_RESET_TRIGGER_COMMAND = 0x02;
+// RF_DEACTIVATE_NTF reason: the host asked for it
+static const uint8_t SIM_DEACTIVATION_REASON_DH_REQUEST = 0x00;
+static const uint8_t SIM_T2T_ACK_STATUS = 0x00;
+static const uint8_t SIM_T2T_NAK = 0x00;
+static const uint8_t SIM_T2T_CC_SIZE = 0x12;  // 144 byte data area
+
+SimulatedT2T make_t2t(const std::vector<uint8_t> &uid, const std::vector<uint8_t> &ndef) {
+  SimulatedT2T tag{uid, {}};
+  // pages 0-2: UID, check bytes and lock bytes; page 3: capability container
+  tag.memory.resize(nfc::MIFARE_ULTRALIGHT_DATA_START_PAGE * nfc::MIFARE_ULTRALIGHT_PAGE_SIZE + SIM_T2T_CC_SIZE * 8);
+  std::copy(uid.begin(), uid.begin() + std::min<size_t>(uid.size(), 9), tag.memory.begin());
+  const uint8_t cc[] = {0xE1, 0x10, SIM_T2T_CC_SIZE, 0x00};
+  std::copy(std::begin(cc), std::end(cc), tag.memory.begin() + 3 * nfc::MIFARE_ULTRALIGHT_PAGE_SIZE);
+
+  size_t offset = nfc::MIFARE_ULTRALIGHT_DATA_START_PAGE * nfc::MIFARE_ULTRALIGHT_PAGE_SIZE;
+  tag.memory[offset++] = nfc::TLV_NDEF_MESSAGE;
+  if (ndef.size() < nfc::TLV_LONG_LENGTH) {
+    tag.memory[offset++] = ndef.size();
+  } else {
+    tag.memory[offset++] = nfc::TLV_LONG_LENGTH;
+    tag.memory[offset++] = ndef.size() >> 8;
+    tag.memory[offset++] = ndef.size() & 0xFF;
+  }
+  if (offset + ndef.size() + 1 > tag.memory.size()) {
+    tag.memory.resize(offset + ndef.size() + 1);
+  }
+  std::copy(ndef.begin(), ndef.end(), tag.memory.begin() + offset);
+  tag.memory[offset + ndef.size()] = nfc::TLV_TERMINATOR;
+  return tag;
+}
+
+void NciControllerSim::place_tag(const SimulatedT2T &tag) {
+  this->tag_ = tag;
+  this->tag_present_ = true;
+}
+
+void NciControllerSim::remove_tag() {
+  this->tag_present_ = false;
+  if (this->rf_state_ == SimRfState::POLL_ACTIVE) {
+    // the tag left the field while it was active; the NFCC falls back to discovery by itself
+    this->rf_state_ = SimRfState::DISCOVERY;
+    this->notify_(nfc::RF_GID, nfc::RF_DEACTIVATE_OID, {nfc::DEACTIVATION_TYPE_DISCOVERY, 0x02});
+  }
+}
+
+void NciControllerSim::discovery_cycle() {
+  if (this->rf_state_ == SimRfState::DISCOVERY && this->tag_present_) {
+    this->activate_();
+  }
+}
+
+void NciControllerSim::set_ven(const bool ven) {
+  if (ven && !this->powered_) {
+    // power-up: nothing is configured until the host resets and initializes the core
+    this->reset_ = false;
+    this->initialized_ = false;
+    this->rf_state_ = SimRfState::IDLE;
+    this->discover_map_.clear();
+    this->to_host_.clear();
+    this->host_data_.clear();
+  }
+  this->powered_ = ven;
+}
+
+void NciControllerSim::host_write(const uint8_t *data, const size_t len) {
+  if (!this->powered_) {
+    this->violation_("write while VEN is low");
+    return;
+  }
+  if (len < nfc::NCI_PKT_HEADER_SIZE || len != size_t(nfc::NCI_PKT_HEADER_SIZE + data[nfc::NCI_PKT_LENGTH_OFFSET])) {
+    this->violation_("packet length does not match its header");
+    return;
+  }
+  const nfc::NciMessage packet(std::vector<uint8_t>(data, data + len));
+
+  if (packet.message_type_is(nfc::NCI_PKT_MT_DATA)) {
+    this->handle_data_(packet);
+  } else if (packet.message_type_is(nfc::NCI_PKT_MT_CTRL_COMMAND)) {
+    if (packet.pbf_is_set()) {
+      this->violation_("segmented control command");
+      return;
+    }
+    this->control_log_.emplace_back(data, data + len);
+    this->handle_command_(packet);
+  } else {
+    this->violation_("host sent a response or notification");
+  }
+}
+
+bool NciControllerSim::host_read(nfc::NciMessage &rx) {
+  if (this->to_host_.empty()) {
+    return false;
+  }
+  rx = this->to_host_.front();
+  this->to_host_.pop_front();
+
+  // a credit only counts once the host has seen the notification carrying it
+  if (rx.message_type_is(nfc::NCI_PKT_MT_CTRL_NOTIFICATION) && rx.gid_is(nfc::NCI_CORE_GID) &&
+      rx.oid_is(nfc::NCI_CORE_CONN_CREDITS_OID) && this->credits_ != nfc::NCI_CONN_CREDITS_FLOW_CONTROL_DISABLED) {
+    this->credits_ += rx.get_message_byte(nfc::CORE_CONN_CREDITS_NTF_ENTRIES + 1);
+  }
+  return true;
+}
+
+void NciControllerSim::handle_command_(const nfc::NciMessage &cmd) {
+  if (cmd.gid_is(nfc::NCI_CORE_GID) && cmd.oid_is(nfc::NCI_CORE_RESET_OID)) {
+    this->core_reset_(cmd);
+    return;
+  }
+  if (!this->reset_) {
+    this->violation_("command before CORE_RESET_CMD");
+    this->respond_(cmd, {nfc::STATUS_NOT_INITIALIZED});
+    return;
+  }
+  if (cmd.gid_is(nfc::NCI_CORE_GID) && cmd.oid_is(nfc::NCI_CORE_INIT_OID)) {
+    this->core_init_(cmd);
+    return;
+  }
+  if (!this->initialized_) {
+    this->violation_("command before CORE_INIT_CMD");
+    this->respond_(cmd, {nfc::STATUS_NOT_INITIALIZED});
+    return;
+  }
+
+  if (cmd.gid_is(nfc::NCI_CORE_GID) && cmd.oid_is(nfc::NCI_CORE_SET_CONFIG_OID)) {
+    // number of parameters, then tag, length and value of each
+    const uint8_t *payload = cmd.payload();
+    if (!cmd.has_payload() || payload[0] != 1 || payload[1] != CONFIG_TOTAL_DURATION || payload[2] != 2 ||
+        cmd.get_payload_size() != 5) {
+      this->violation_("unexpected CORE_SET_CONFIG_CMD");
+    }
+    this->discovery_period_.assign(payload + 3, payload + cmd.get_payload_size());
+    this->respond_(cmd, {nfc::STATUS_OK, 0x00});
+    return;
+  }
+
+  if (cmd.gid_is(nfc::RF_GID) && cmd.oid_is(nfc::RF_DISCOVER_MAP_OID)) {
+    if (this->rf_state_ != SimRfState::IDLE) {
+      this->violation_("RF_DISCOVER_MAP_CMD outside RFST_IDLE");
+      this->respond_(cmd, {nfc::STATUS_SEMANTIC_ERROR});
+      return;
+    }
+    if (!cmd.has_payload() || cmd.get_payload_size() != 1 + cmd.payload()[0] * 3) {
+      this->violation_("malformed RF_DISCOVER_MAP_CMD");
+      this->respond_(cmd, {nfc::STATUS_SYNTAX_ERROR});
+      return;
+    }
+    this->discover_map_.assign(cmd.payload() + 1, cmd.payload() + cmd.get_payload_size());
+    this->respond_(cmd, {nfc::STATUS_OK});
+    return;
+  }
+
+  if (cmd.gid_is(nfc::RF_GID) && cmd.oid_is(nfc::RF_DISCOVER_OID)) {
+    if (this->rf_state_ != SimRfState::IDLE || this->discover_map_.empty()) {
+      this->violation_("RF_DISCOVER_CMD outside RFST_IDLE or without a discover map");
+      this->respond_(cmd, {nfc::STATUS_SEMANTIC_ERROR});
+      return;
+    }
+    if (!cmd.has_payload() || cmd.get_payload_size() != 1 + cmd.payload()[0] * 2) {
+      this->violation_("malformed RF_DISCOVER_CMD");
+      this->respond_(cmd, {nfc::STATUS_SYNTAX_ERROR});
+      return;
+    }
+    this->rf_state_ = SimRfState::DISCOVERY;
+    this->respond_(cmd, {nfc::STATUS_OK});
+    return;
+  }
+
+  if (cmd.gid_is(nfc::RF_GID) && cmd.oid_is(nfc::RF_DEACTIVATE_OID)) {
+    this->rf_deactivate_(cmd);
+    return;
+  }
+
+  this->violation_("unsupported command");
+  this->respond_(cmd, {nfc::STATUS_REJECTED});
+}
+
+void NciControllerSim::core_reset_(const nfc::NciMessage &cmd) {
+  this->reset_ = true;
+  this->initialized_ = false;
+  this->rf_state_ = SimRfState::IDLE;
+  this->host_data_.clear();
+  const uint8_t config_status = cmd.get_message_byte(nfc::NCI_PKT_PAYLOAD_OFFSET);
+  if ((this->nci_version & 0xF0) == NCI_VERSION_1_0) {
+    // NCI 1.0: status, NCI version, configuration status
+    this->respond_(cmd, {nfc::STATUS_OK, this->nci_version, config_status});
+  } else {
+    // NCI 2.0: the version follows in CORE_RESET_NTF, after the manufacturer ID and no manufacturer information
+    this->respond_(cmd, {nfc::STATUS_OK});
+    this->notify_(nfc::NCI_CORE_GID, nfc::NCI_CORE_RESET_OID,
+                  {SIM_RESET_TRIGGER_COMMAND, config_status, this->nci_version, 0x04, 0x00});
+  }
+}
+
+void NciControllerSim::core_init_(const nfc::NciMessage &cmd) {
+  if ((this->nci_version & 0xF0) == NCI_VERSION_1_0) {
+    if (cmd.has_payload()) {
+      this->violation_("NCI 1.0 CORE_INIT_CMD with a payload");
+    }
+    // status, features (4), interfaces (frame, ISO-DEP, NFC-DEP), max logical connections, max routing table
+    // size (2), max control payload, max parameter size (2), manufacturer ID, hardware/ROM/firmware versions
+    this->respond_(cmd, {nfc::STATUS_OK, 0x00, 0x00, 0x00, 0x00, 3, nfc::INTF_FRAME, nfc::INTF_ISODEP,
+                         nfc::INTF_NFCDEP, 0x01, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x04, 0x12, 0x11, 0x08, 0x00});
+  } else {
+    if (cmd.get_payload_size() != 2) {
+      this->violation_("NCI 2.0 CORE_INIT_CMD without its feature bytes");
+    }
+    // status, features (4), max logical connections, max routing table size (2), max control payload, max
+    // HCI data payload, HCI credits, max NFC-V frame size (2), interfaces with their extensions
+    this->respond_(cmd, {nfc::STATUS_OK, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0xFF, 0xFF, 0x01, 0x00, 0x01,
+                         2, nfc::INTF_FRAME, 0x00, nfc::INTF_ISODEP, 0x00});
+  }
+  this->initialized_ = true;
+}
+
+void NciControllerSim::rf_deactivate_(const nfc::NciMessage &cmd) {
+  const uint8_t type = cmd.get_message_byte(nfc::NCI_PKT_PAYLOAD_OFFSET);
+  if (this->rf_state_ == SimRfState::IDLE) {
+    this->violation_("RF_DEACTIVATE_CMD in RFST_IDLE");
+    this->respond_(cmd, {nfc::STATUS_SEMANTIC_ERROR});
+    return;
+  }
+  if (type != nfc::DEACTIVATION_TYPE_IDLE && type != nfc::DEACTIVATION_TYPE_DISCOVERY) {
+    this->violation_("unsupported deactivation type");
+    this->respond_(cmd, {nfc::STATUS_REJECTED});
+    return;
+  }
+  if (!this->host_data_.empty()) {
+    this->violation_("deactivated with a partial data message");
+    this->host_data_.clear();
+  }
+  this->rf_state_ = type == nfc::DEACTIVATION_TYPE_IDLE ? SimRfState::IDLE : SimRfState::DISCOVERY;
+  this->respond_(cmd, {nfc::STATUS_OK});
+  this->notify_(nfc::RF_GID, nfc::RF_DEACTIVATE_OID, {type, SIM_DEACTIVATION_REASON_DH_REQUEST});
+}
+
+void NciControllerSim::activate_() {
+  // the discover map decides which RF interface the tag's protocol is activated with
+  uint8_t interface = 0xFF;
+  for (size_t i = 0; i + 2 < this->discover_map_.size(); i += 3) {
+    if (this->discover_map_[i] == nfc::PROT_T2T && (this->discover_map_[i + 1] & nfc::RF_DISCOVER_MAP_MODE_POLL)) {
+      interface = this->discover_map_[i + 2];
+    }
+  }
+  if (interface != nfc::INTF_FRAME) {
+    this->violation_("T2T not mapped to the frame RF interface");
+    return;
+  }
+
+  this->rf_state_ = SimRfState::POLL_ACTIVE;
+  this->credits_ = this->initial_credits;
+  this->host_data_.clear();
+
+  // discovery ID, interface, protocol, mode/technology, max data payload, initial credits, technology parameters,
+  // data exchange mode/technology, bit rates and (no) activation parameters
+  std::vector<uint8_t> ntf = {0x01,
+                              nfc::INTF_FRAME,
+                              nfc::PROT_T2T,
+                              nfc::MODE_POLL | nfc::TECH_PASSIVE_NFCA,
+                              this->max_data_payload,
+                              this->initial_credits};
+  std::vector<uint8_t> params(std::begin(SIM_SENS_RES), std::end(SIM_SENS_RES));
+  params.push_back(this->tag_.uid.size());
+  params.insert(params.end(), this->tag_.uid.begin(), this->tag_.uid.end());
+  params.push_back(1);
+  params.push_back(SIM_SEL_RES);
+  ntf.push_back(params.size());
+  ntf.insert(ntf.end(), params.begin(), params.end());
+  ntf.insert(ntf.end(), {nfc::MODE_POLL | nfc::TECH_PASSIVE_NFCA, nfc::NFC_BIT_RATE_106, nfc::NFC_BIT_RATE_106, 0});
+  this->notify_(nfc::RF_GID, nfc::RF_INTF_ACTIVATED_OID, ntf);
+}
+
+void NciControllerSim::handle_data_(const nfc::NciMessage &data) {
+  this->host_data_packets_++;
+  if (this->rf_state_ != SimRfState::POLL_ACTIVE) {
+    this->violation_("data packet without an active tag");
+    return;
+  }
+  if (!data.gid_is(STATIC_RF_CONN_ID)) {
+    this->violation_("data packet for an unknown connection");
+    return;
+  }
+  if (data.get_payload_size() > this->max_data_payload) {
+    this->violation_("data packet larger than the announced maximum");
+  }
+  if (this->credits_ != nfc::NCI_CONN_CREDITS_FLOW_CONTROL_DISABLED) {
+    if (this->credits_ == 0) {
+      this->violation_("data packet sent without a credit");
+    } else {
+      if (this->credits_ == 1 && data.pbf_is_set()) {
+        // the next segment has to wait for the credit this packet's buffer returns
+        this->credit_waits_++;
+      }
+      this->credits_--;
+    }
+    // the packet is consumed at once, so its buffer is handed back straight away
+    this->notify_(nfc::NCI_CORE_GID, nfc::NCI_CORE_CONN_CREDITS_OID, {1, STATIC_RF_CONN_ID, 1});
+  }
+
+  this->host_data_.insert(this->host_data_.end(), data.payload(), data.payload() + data.get_payload_size());
+  if (data.pbf_is_set()) {
+    this->host_segmented_packets_++;
+    return;
+  }
+  std::vector<uint8_t> command;
+  command.swap(this->host_data_);
+  this->answer_t2t_(command);
+}
+
+void NciControllerSim::answer_t2t_(const std::vector<uint8_t> &command) {
+  if (!this->tag_present_) {
+    // no answer from the tag: the frame interface reports the RF timeout as the status
+    this->send_data_({nfc::RF_TIMEOUT_ERROR});
+    return;
+  }
+  const size_t read_size = nfc::MIFARE_ULTRALIGHT_READ_SIZE * nfc::MIFARE_ULTRALIGHT_PAGE_SIZE;
+  if (command.size() == 2 && command[0] == nfc::MIFARE_CMD_READ) {
+    const size_t start = command[1] * nfc::MIFARE_ULTRALIGHT_PAGE_SIZE;
+    this->t2t_reads_.push_back(command[1]);
+    if (start >= this->tag_.memory.size()) {
+      this->send_data_({SIM_T2T_NAK, SIM_T2T_ACK_STATUS});
+      return;
+    }
+    // READ rolls over to page 0 past the end of the memory
+    std::vector<uint8_t> answer;
+    for (size_t i = 0; i < read_size; i++) {
+      answer.push_back(this->tag_.memory[(start + i) % this->tag_.memory.size()]);
+    }
+    answer.push_back(SIM_T2T_ACK_STATUS);
+    this->send_data_(answer);
+    return;
+  }
+  this->violation_("unsupported T2T command");
+  this->send_data_({SIM_T2T_NAK, SIM_T2T_ACK_STATUS});
+}
+
+void NciControllerSim::respond_(const nfc::NciMessage &cmd, std::initializer_list<uint8_t> payload) {
+  this->to_host_.emplace_back(nfc::NCI_PKT_MT_CTRL_RESPONSE, cmd.get_gid(), cmd.get_oid(), payload);
+}
+
+void NciControllerSim::notify_(const uint8_t gid, const uint8_t oid, const std::vector<uint8_t> &payload) {
+  this->to_host_.emplace_back(nfc::NCI_PKT_MT_CTRL_NOTIFICATION, gid, oid, payload);
+}
+
+void NciControllerSim::send_data_(const std::vector<uint8_t> &data) {
+  size_t offset = 0;
+  do {
+    const size_t segment = std::min<size_t>(data.size() - offset, this->host_segment_size);
+    nfc::NciMessage packet;
+    packet.set_header(nfc::NCI_PKT_MT_DATA, STATIC_RF_CONN_ID, 0x00);
+    packet.set_pbf(offset + segment < data.size());
+    packet.set_payload(data.data() + offset, segment);
+    this->to_host_.push_back(packet);
+    this->nfcc_data_packets_++;
+    offset += segment;
+  } while (offset < data.size());
+}
+
+void NciControllerSim::violation_(const std::string &what) { this->violations_.push_back(what); }
+
+SimulatedPN7150::SimulatedPN7150(NciControllerSim *sim) : sim_(sim) {
+  this->set_irq_pin(&this->irq_);
+  this->set_ven_pin(&this->ven_);
+}
+
+uint8_t SimulatedPN7150::read_nfcc(nfc::NciMessage &rx, const uint16_t timeout) {
+  if (this->wait_for_irq_(timeout) != nfc::STATUS_OK) {
+    return nfc::STATUS_FAILED;
+  }
+  return this->sim_->host_read(rx) ? nfc::STATUS_OK : nfc::STATUS_FAILED;
+}
+
+uint8_t SimulatedPN7150::write_nfcc(nfc::NciMessage &tx) {
+  auto packet = tx.encode();
+  this->sim_->host_write(packet.data(), packet.size());
+  return nfc::STATUS_OK;
+}
+
+}  // namespace testing
+}  // namespace pn7150
+}  // namespace esphome
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "esphome/core/gpio.h"
+#include "esphome/components/nfc/nci_core.h"
+#include "esphome/components/nfc/nci_message.h"
+#include "esphome/components/pn7150/pn7150.h"
+
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace pn7150 {
+namespace testing {
+
+/// An NFC Forum Type 2 tag: its memory is read 16 bytes (four pages) at a time with READ
+struct SimulatedT2T {
+  std::vector<uint8_t> uid;
+  std::vector<uint8_t> memory;
+};
+
+/// Builds the memory of a Type 2 tag holding `ndef` in an NDEF TLV after its capability container
+SimulatedT2T make_t2t(const std::vector<uint8_t> &uid, const std::vector<uint8_t> &ndef);
+
+enum class SimRfState : uint8_t {
+  IDLE,
+  DISCOVERY,
+  POLL_ACTIVE,
+};
+
+/// Models the host interface of a PN7150 (NCI 1.0) or PN7160 (NCI 2.0): control commands get their responses and
+/// notifications, data packets sent to an activated Type 2 tag get its answer through the frame RF interface.
+/// Anything the host does that an NFCC would reject or that breaks NCI flow control is recorded as a violation.
+class NciControllerSim {
+ public:
+  // configuration, applied from the next CORE_RESET_CMD or activation
+  uint8_t nci_version{0x10};
+  /// Max Data Packet Payload Size announced in RF_INTF_ACTIVATED_NTF
+  uint8_t max_data_payload{nfc::NCI_MAX_PAYLOAD_SIZE};
+  /// Initial Number of Credits announced in RF_INTF_ACTIVATED_NTF
+  uint8_t initial_credits{1};
+  /// the largest data packet payload the NFCC sends to the host; longer answers are segmented
+  uint8_t host_segment_size{nfc::NCI_MAX_PAYLOAD_SIZE};
+
+  /// puts a tag into the field; it is activated in the next discovery cycle
+  void place_tag(const SimulatedT2T &tag);
+  void remove_tag();
+  /// runs one RF discovery cycle: a tag in the field is activated and reported with RF_INTF_ACTIVATED_NTF
+  void discovery_cycle();
+
+  // the host interface
+  void set_ven(bool ven);
+  bool irq() const { return !this->to_host_.empty(); }
+  void host_write(const uint8_t *data, size_t len);
+  bool host_read(nfc::NciMessage &rx);
+
+  // what the host did
+  SimRfState get_rf_state() const { return this->rf_state_; }
+  const std::vector<std::vector<uint8_t>> &get_control_log() const { return this->control_log_; }
+  const std::vector<uint8_t> &get_discovery_period() const { return this->discovery_period_; }
+  const std::vector<uint8_t> &get_t2t_reads() const { return this->t2t_reads_; }
+  uint32_t get_host_data_packets() const { return this->host_data_packets_; }
+  uint32_t get_host_segmented_packets() const { return this->host_segmented_packets_; }
+  uint32_t get_credit_waits() const { return this->credit_waits_; }
+  uint32_t get_nfcc_data_packets() const { return this->nfcc_data_packets_; }
+  const std::vector<std::string> &get_violations() const { return this->violations_; }
+
+ protected:
+  void handle_command_(const nfc::NciMessage &cmd);
+  void handle_data_(const nfc::NciMessage &data);
+  void core_reset_(const nfc::NciMessage &cmd);
+  void core_init_(const nfc::NciMessage &cmd);
+  void rf_deactivate_(const nfc::NciMessage &cmd);
+  void activate_();
+  void answer_t2t_(const std::vector<uint8_t> &command);
+
+  void respond_(const nfc::NciMessage &cmd, std::initializer_list<uint8_t> payload);
+  void notify_(uint8_t gid, uint8_t oid, const std::vector<uint8_t> &payload);
+  void send_data_(const std::vector<uint8_t> &data);
+  void violation_(const std::string &what);
+
+  bool powered_{false};
+  bool reset_{false};
+  bool initialized_{false};
+  SimRfState rf_state_{SimRfState::IDLE};
+  std::vector<uint8_t> discover_map_;
+  std::vector<uint8_t> discovery_period_;
+  bool tag_present_{false};
+  SimulatedT2T tag_;
+
+  uint8_t credits_{0};  // credits the host holds for the static RF connection
+  std::vector<uint8_t> host_data_;  // segments received so far
+  std::deque<nfc::NciMessage> to_host_;
+
+  std::vector<std::vector<uint8_t>> control_log_;
+  std::vector<uint8_t> t2t_reads_;  // pages read
+  uint32_t host_data_packets_{0};
+  uint32_t host_segmented_packets_{0};
+  uint32_t credit_waits_{0};
+  uint32_t nfcc_data_packets_{0};
+  std::vector<std::string> violations_;
+};
+
+/// PN7150 whose transport talks to the simulator, the way PN7150I2C talks to the bus
+class SimulatedPN7150 : public PN7150 {
+ public:
+  explicit SimulatedPN7150(NciControllerSim *sim);
+
+  NCIState get_state() const { return this->nci_state_; }
+  uint8_t get_nci_version() const { return this->nci_version_; }
+
+ protected:
+  uint8_t read_nfcc(nfc::NciMessage &rx, uint16_t timeout) override;
+  uint8_t write_nfcc(nfc::NciMessage &tx) override;
+
+  class IrqPin : public GPIOPin {
+   public:
+    explicit IrqPin(NciControllerSim *sim) : sim_(sim) {}
+    void setup() override {}
+    bool digital_read() override { return this->sim_->irq(); }
+    void digital_write(bool value) override {}
+    std::string dump_summary() const override { return "simulated IRQ"; }
+
+   protected:
+    NciControllerSim *sim_;
+  };
+
+  class VenPin : public GPIOPin {
+   public:
+    explicit VenPin(NciControllerSim *sim) : sim_(sim) {}
+    void setup() override {}
+    bool digital_read() override { return false; }
+    void digital_write(bool value) override { this->sim_->set_ven(value); }
+    std::string dump_summary() const override { return "simulated VEN"; }
+
+   protected:
+    NciControllerSim *sim_;
+  };
+
+  NciControllerSim *sim_;
+  IrqPin irq_{sim_};
+  VenPin ven_{sim_};
+};
+
+}  // namespace testing
+}  // namespace pn7150
+}  // namespace esphome
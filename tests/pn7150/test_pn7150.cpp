@@ -0,0 +1,245 @@
+#include "nci_controller_sim.h"
+#include "esphome/core/hal.h"
+#include "esphome/components/nfc/nfc.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Runs the PN7150 driver against the simulated NFCC: core reset and initialization, autonomous discovery, a Type 2
+// tag read through the frame RF interface and the hand-back to discovery, and data exchanges that only fit when
+// segmented and paced by connection credits.
+
+using namespace esphome;
+using namespace esphome::pn7150;
+using namespace esphome::pn7150::testing;
+
+static int failures = 0;  // NOLINT
+
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+      failures++; \
+    } \
+  } while (false)
+
+static const std::vector<uint8_t> TAG_UID = {0x04, 0x9A, 0x3C, 0x12, 0x5B, 0x61, 0x80};
+static const char *const TAG_URI = "https://www.home-assistant.io/tag/5e1b6a3c-0d7f-4c2b-9a61-3f0e2d8c7b45";
+static const char *const TAG_TEXT = "water meter 1";
+
+class RecordingListener : public nfc::NfcTagListener {
+ public:
+  void tag_on(nfc::NfcTag &tag) override { this->on.emplace_back(tag); }
+  void tag_off(nfc::NfcTag &tag) override { this->off.emplace_back(tag); }
+
+  std::vector<nfc::NfcTag> on;
+  std::vector<nfc::NfcTag> off;
+};
+
+static std::vector<uint8_t> tag_message() {
+  nfc::NdefMessage message;
+  message.add_uri_record(TAG_URI);
+  message.add_text_record(TAG_TEXT);
+  return message.encode();
+}
+
+static void configure(SimulatedPN7150 &reader) {
+  // what the pn7150 component's defaults generate: T2T over the frame interface, NFC-A, B and F polling
+  reader.add_discover_map_entry(nfc::PROT_T2T, nfc::INTF_FRAME);
+  reader.add_discover_map_entry(nfc::PROT_ISODEP, nfc::INTF_ISODEP);
+  reader.add_discovery_technology(nfc::TECH_PASSIVE_NFCA);
+  reader.add_discovery_technology(nfc::TECH_PASSIVE_NFCB);
+  reader.add_discovery_technology(nfc::TECH_PASSIVE_NFCF);
+  reader.set_discovery_period(500);
+  reader.set_tag_ttl(1000);
+}
+
+static void run_loop(SimulatedPN7150 &reader) {
+  // the driver handles one message per loop(); give it as many as the NFCC has queued
+  for (int i = 0; i < 100 && reader.get_state() != NCIState::FAILED; i++) {
+    reader.loop();
+  }
+}
+
+static bool command_is(const std::vector<uint8_t> &packet, uint8_t gid, uint8_t oid) {
+  return packet.size() >= nfc::NCI_PKT_HEADER_SIZE &&
+         (packet[nfc::NCI_PKT_MT_GID_OFFSET] & nfc::NCI_PKT_GID_MASK) == gid &&
+         (packet[nfc::NCI_PKT_OID_OFFSET] & nfc::NCI_PKT_OID_MASK) == oid;
+}
+
+static void check_no_violations(const NciControllerSim &sim) {
+  for (const auto &violation : sim.get_violations()) {
+    printf("NCI violation: %s\n", violation.c_str());
+  }
+  CHECK(sim.get_violations().empty());
+}
+
+static void check_tag(const nfc::NfcTag &seen) {
+  nfc::NfcTag tag(seen);
+  CHECK(tag.get_uid() == TAG_UID);
+  CHECK(tag.get_tag_type() == nfc::NFC_FORUM_TYPE_2);
+  CHECK(tag.has_ndef_message());
+  if (!tag.has_ndef_message()) {
+    return;
+  }
+  const auto &records = tag.get_ndef_message()->get_records();
+  CHECK(records.size() == 2);
+  if (records.size() == 2) {
+    CHECK(records[0]->get_payload() == TAG_URI);
+    CHECK(records[1]->get_payload() == TAG_TEXT);
+  }
+}
+
+static void test_core_reset_and_init(uint8_t nci_version) {
+  printf("-- core reset and init, NCI %u.%u\n", nci_version >> 4, nci_version & 0x0F);
+  NciControllerSim sim;
+  sim.nci_version = nci_version;
+  SimulatedPN7150 reader(&sim);
+  configure(reader);
+
+  reader.setup();
+
+  CHECK(reader.get_state() == NCIState::RFST_DISCOVERY);
+  CHECK(reader.get_nci_version() == nci_version);
+  CHECK(sim.get_rf_state() == SimRfState::DISCOVERY);
+  const auto &log = sim.get_control_log();
+  CHECK(log.size() == 5);
+  if (log.size() == 5) {
+    CHECK(command_is(log[0], nfc::NCI_CORE_GID, nfc::NCI_CORE_RESET_OID));
+    CHECK(command_is(log[1], nfc::NCI_CORE_GID, nfc::NCI_CORE_INIT_OID));
+    CHECK(command_is(log[2], nfc::NCI_CORE_GID, nfc::NCI_CORE_SET_CONFIG_OID));
+    CHECK(command_is(log[3], nfc::RF_GID, nfc::RF_DISCOVER_MAP_OID));
+    CHECK(command_is(log[4], nfc::RF_GID, nfc::RF_DISCOVER_OID));
+    // three technologies, each polled in every discovery period
+    CHECK(log[4].size() == nfc::NCI_PKT_HEADER_SIZE + 7);
+  }
+  CHECK(sim.get_discovery_period() == std::vector<uint8_t>({500 & 0xFF, 500 >> 8}));
+  // discovery runs on the NFCC: nothing for the host until a tag shows up
+  CHECK(!sim.irq());
+  check_no_violations(sim);
+}
+
+static void test_t2t_read_and_deactivate() {
+  printf("-- RF discovery, T2T read, deactivation\n");
+  NciControllerSim sim;
+  SimulatedPN7150 reader(&sim);
+  RecordingListener listener;
+  reader.register_listener(&listener);
+  configure(reader);
+  reader.setup();
+
+  run_loop(reader);
+  CHECK(listener.on.empty());
+
+  sim.place_tag(make_t2t(TAG_UID, tag_message()));
+  sim.discovery_cycle();
+  CHECK(sim.get_rf_state() == SimRfState::POLL_ACTIVE);
+  run_loop(reader);
+
+  CHECK(listener.on.size() == 1);
+  if (listener.on.size() == 1) {
+    check_tag(listener.on[0]);
+  }
+  // pages 3-6 first, then the rest of the 80 byte message four pages at a time
+  CHECK(sim.get_t2t_reads() == std::vector<uint8_t>({3, 7, 11, 15, 19, 23}));
+  // the tag goes back to the NFCC, which resumes discovery on its own
+  CHECK(command_is(sim.get_control_log().back(), nfc::RF_GID, nfc::RF_DEACTIVATE_OID));
+  CHECK(sim.get_control_log().back()[nfc::NCI_PKT_PAYLOAD_OFFSET] == nfc::DEACTIVATION_TYPE_DISCOVERY);
+  CHECK(sim.get_rf_state() == SimRfState::DISCOVERY);
+  CHECK(reader.get_state() == NCIState::RFST_DISCOVERY);
+  // no segmentation with the default 255 byte packets
+  CHECK(sim.get_host_segmented_packets() == 0);
+
+  // still in the field on the next cycle: activated again, but neither read nor reported again
+  const size_t reads = sim.get_t2t_reads().size();
+  sim.discovery_cycle();
+  run_loop(reader);
+  CHECK(listener.on.size() == 1);
+  CHECK(sim.get_t2t_reads().size() == reads);
+  CHECK(sim.get_rf_state() == SimRfState::DISCOVERY);
+
+  // gone: reported as removed once its time to live runs out
+  sim.remove_tag();
+  sim.discovery_cycle();
+  run_loop(reader);
+  CHECK(listener.off.empty());
+  host::advance_millis(2000);
+  run_loop(reader);
+  CHECK(listener.off.size() == 1);
+  if (listener.off.size() == 1) {
+    CHECK(listener.off[0].get_uid() == TAG_UID);
+  }
+  check_no_violations(sim);
+}
+
+static void test_segmented_exchange() {
+  printf("-- segmented data exchange with credit-based flow control\n");
+  NciControllerSim sim;
+  // a two byte READ only fits in two packets, and the single credit must come back before the second is sent;
+  // the 17 byte answers (16 data bytes and the frame interface status) come back in 5 byte segments
+  sim.max_data_payload = 1;
+  sim.initial_credits = 1;
+  sim.host_segment_size = 5;
+  SimulatedPN7150 reader(&sim);
+  RecordingListener listener;
+  reader.register_listener(&listener);
+  configure(reader);
+  reader.setup();
+
+  sim.place_tag(make_t2t(TAG_UID, tag_message()));
+  sim.discovery_cycle();
+  run_loop(reader);
+
+  CHECK(listener.on.size() == 1);
+  if (listener.on.size() == 1) {
+    check_tag(listener.on[0]);
+  }
+  const uint32_t reads = sim.get_t2t_reads().size();
+  CHECK(reads == 6);
+  CHECK(sim.get_host_data_packets() == reads * 2);
+  CHECK(sim.get_host_segmented_packets() == reads);
+  CHECK(sim.get_credit_waits() == reads);
+  CHECK(sim.get_nfcc_data_packets() == reads * 4);
+  CHECK(sim.get_rf_state() == SimRfState::DISCOVERY);
+  check_no_violations(sim);
+}
+
+static void test_flow_control_disabled() {
+  printf("-- segmented data exchange without flow control\n");
+  NciControllerSim sim;
+  sim.max_data_payload = 1;
+  sim.initial_credits = nfc::NCI_CONN_CREDITS_FLOW_CONTROL_DISABLED;
+  SimulatedPN7150 reader(&sim);
+  RecordingListener listener;
+  reader.register_listener(&listener);
+  configure(reader);
+  reader.setup();
+
+  sim.place_tag(make_t2t(TAG_UID, tag_message()));
+  sim.discovery_cycle();
+  run_loop(reader);
+
+  CHECK(listener.on.size() == 1);
+  if (listener.on.size() == 1) {
+    check_tag(listener.on[0]);
+  }
+  CHECK(sim.get_credit_waits() == 0);
+  CHECK(sim.get_host_segmented_packets() == sim.get_t2t_reads().size());
+  check_no_violations(sim);
+}
+
+int main() {
+  test_core_reset_and_init(0x10);
+  test_core_reset_and_init(0x20);
+  test_t2t_read_and_deactivate();
+  test_segmented_exchange();
+  test_flow_control_disabled();
+
+  if (failures != 0) {
+    printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  printf("All checks passed\n");
+  return 0;
+}